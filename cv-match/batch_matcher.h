@@ -0,0 +1,285 @@
+#pragma once
+
+// Batched multi-template matcher.
+//
+// The gray source is kept resident as a UMat, all templates are packed into
+// one atlas UMat, and a single matchBatch launch scores every template at
+// every position. Each work-group reduces its tile to a min and a max
+// candidate in local memory, so no per-template result map is ever written;
+// one reduceBatch launch then folds the tile candidates per template and only
+// nTemplates * 2 values come back to the host.
+
+#include "cv_common.h"
+
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+
+struct MatchHit {
+    int templ;        // template index
+    cv::Point loc;    // best location, (-1,-1) if the template does not fit
+    float score;      // score at loc
+};
+
+static const char* batchMatchSource = R"(
+    // keep the lower index on ties, like cv::minMaxLoc
+    #define BETTER_MIN(v, i, cv, ci) ((i) >= 0 && ((v) < (cv) || ((v) == (cv) && (i) < (ci)) || (ci) < 0))
+    #define BETTER_MAX(v, i, cv, ci) ((i) >= 0 && ((v) > (cv) || ((v) == (cv) && (i) < (ci)) || (ci) < 0))
+
+    __kernel void matchBatch(__global const uchar* src, int src_step, int src_offset, int src_rows, int src_cols,
+                             __global const uchar* atlas, int atlas_step, int atlas_offset,
+                             __global const int* desc, __global const float* stats,
+                             int method, int groups_x, int groups_per_templ,
+                             __global float* part_val, __global int* part_idx)
+    {
+        __local float lmin[TILE_X * TILE_Y];
+        __local float lmax[TILE_X * TILE_Y];
+        __local int imin[TILE_X * TILE_Y];
+        __local int imax[TILE_X * TILE_Y];
+
+        int x = get_global_id(0);
+        int y = get_global_id(1);
+        int t = get_global_id(2);
+        int lid = get_local_id(1) * TILE_X + get_local_id(0);
+
+        int ay = desc[4 * t];
+        int tw = desc[4 * t + 1];
+        int th = desc[4 * t + 2];
+        int rcols = src_cols - tw + 1;
+        int rrows = src_rows - th + 1;
+
+        float vmin = INFINITY, vmax = -INFINITY;
+        int idx = -1;
+        if (x < rcols && y < rrows) {
+            float sIT = 0.f, sI = 0.f, sI2 = 0.f, sD2 = 0.f;
+            for (int j = 0; j < th; ++j) {
+                __global const uchar* srow = src + src_offset + (y + j) * src_step + x;
+                __global const uchar* trow = atlas + atlas_offset + (ay + j) * atlas_step;
+                for (int i = 0; i < tw; ++i) {
+                    float a = srow[i];
+                    float b = trow[i];
+                    float d = a - b;
+                    sIT += a * b;
+                    sI += a;
+                    sI2 += a * a;
+                    sD2 += d * d;
+                }
+            }
+            float s = matchScore(method, sIT, sI, sI2, sD2,
+                                 stats[4 * t], stats[4 * t + 1], stats[4 * t + 2], (float)(tw * th));
+            vmin = vmax = s;
+            idx = y * rcols + x;
+        }
+        lmin[lid] = vmin; lmax[lid] = vmax;
+        imin[lid] = idx;  imax[lid] = idx;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int s = TILE_X * TILE_Y / 2; s > 0; s >>= 1) {
+            if (lid < s) {
+                if (BETTER_MIN(lmin[lid + s], imin[lid + s], lmin[lid], imin[lid])) {
+                    lmin[lid] = lmin[lid + s]; imin[lid] = imin[lid + s];
+                }
+                if (BETTER_MAX(lmax[lid + s], imax[lid + s], lmax[lid], imax[lid])) {
+                    lmax[lid] = lmax[lid + s]; imax[lid] = imax[lid + s];
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (lid == 0) {
+            int g = t * groups_per_templ + get_group_id(1) * groups_x + get_group_id(0);
+            part_val[2 * g] = lmin[0];
+            part_val[2 * g + 1] = lmax[0];
+            part_idx[2 * g] = imin[0];
+            part_idx[2 * g + 1] = imax[0];
+        }
+    }
+
+    // one work-group per template folds its tile candidates
+    __kernel void reduceBatch(__global const float* part_val, __global const int* part_idx, int groups_per_templ,
+                              __global float* out_val, __global int* out_idx)
+    {
+        __local float lmin[RED_WG];
+        __local float lmax[RED_WG];
+        __local int imin[RED_WG];
+        __local int imax[RED_WG];
+
+        int t = get_group_id(0);
+        int lid = get_local_id(0);
+        __global const float* pv = part_val + 2 * t * groups_per_templ;
+        __global const int* pi = part_idx + 2 * t * groups_per_templ;
+
+        float vmin = INFINITY, vmax = -INFINITY;
+        int jmin = -1, jmax = -1;
+        for (int g = lid; g < groups_per_templ; g += RED_WG) {
+            if (BETTER_MIN(pv[2 * g], pi[2 * g], vmin, jmin)) {
+                vmin = pv[2 * g]; jmin = pi[2 * g];
+            }
+            if (BETTER_MAX(pv[2 * g + 1], pi[2 * g + 1], vmax, jmax)) {
+                vmax = pv[2 * g + 1]; jmax = pi[2 * g + 1];
+            }
+        }
+        lmin[lid] = vmin; lmax[lid] = vmax;
+        imin[lid] = jmin; imax[lid] = jmax;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int s = RED_WG / 2; s > 0; s >>= 1) {
+            if (lid < s) {
+                if (BETTER_MIN(lmin[lid + s], imin[lid + s], lmin[lid], imin[lid])) {
+                    lmin[lid] = lmin[lid + s]; imin[lid] = imin[lid + s];
+                }
+                if (BETTER_MAX(lmax[lid + s], imax[lid + s], lmax[lid], imax[lid])) {
+                    lmax[lid] = lmax[lid + s]; imax[lid] = imax[lid + s];
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (lid == 0) {
+            out_val[2 * t] = lmin[0];
+            out_val[2 * t + 1] = lmax[0];
+            out_idx[2 * t] = imin[0];
+            out_idx[2 * t + 1] = imax[0];
+        }
+    }
+)";
+
+class BatchMatcher {
+public:
+    explicit BatchMatcher(int method = cv::TM_SQDIFF)
+        : method_(method), source_(std::string(matchScoreSource) + batchMatchSource) {
+        size_t maxWg = cv::ocl::Device::getDefault().maxWorkGroupSize();
+        tile_ = maxWg >= 256 ? 16 : 8;
+        // the tree reduction in reduceBatch halves RED_WG: power of two
+        redWg_ = 1;
+        while ((size_t)redWg_ * 2 <= std::min<size_t>(256, maxWg))
+            redWg_ *= 2;
+        opts_ = cv::format("-D TILE_X=%d -D TILE_Y=%d -D RED_WG=%d", tile_, tile_, redWg_);
+        // build once up front so errors show here; OpenCV caches the program
+        cv::ocl::Kernel matchKernel("matchBatch", source_, opts_), reduceKernel("reduceBatch", source_, opts_);
+        if (matchKernel.empty() || reduceKernel.empty()) {
+            throw std::runtime_error("Failed to build batch match kernels");
+        }
+    }
+
+    // pack all (gray, CV_8UC1) templates into one atlas and upload it once
+    void setTemplates(const std::vector<cv::Mat>& templs) {
+        int atlasW = 1, atlasH = 0;
+        minW_ = INT_MAX;
+        minH_ = INT_MAX;
+        for (const auto& t : templs) {
+            CV_Assert(t.type() == CV_8UC1);
+            atlasW = std::max(atlasW, t.cols);
+            atlasH += t.rows;
+            minW_ = std::min(minW_, t.cols);
+            minH_ = std::min(minH_, t.rows);
+        }
+        cv::Mat atlas(std::max(atlasH, 1), atlasW, CV_8UC1, cv::Scalar(0));
+        cv::Mat desc((int)templs.size(), 4, CV_32SC1, cv::Scalar(0));
+        cv::Mat stats((int)templs.size(), 4, CV_32FC1, cv::Scalar(0));
+        sizes_.clear();
+        int y = 0;
+        for (int i = 0; i < (int)templs.size(); ++i) {
+            const cv::Mat& t = templs[i];
+            t.copyTo(atlas(cv::Rect(0, y, t.cols, t.rows)));
+            desc.at<int>(i, 0) = y;
+            desc.at<int>(i, 1) = t.cols;
+            desc.at<int>(i, 2) = t.rows;
+            TemplStats s = templStats(t);
+            stats.at<float>(i, 0) = s.sumT2;
+            stats.at<float>(i, 1) = s.meanT;
+            stats.at<float>(i, 2) = s.normT;
+            sizes_.push_back(t.size());
+            y += t.rows;
+        }
+        atlas.copyTo(atlas_);
+        desc.copyTo(desc_);
+        stats.copyTo(stats_);
+    }
+
+    // the source stays resident until the next setSource
+    void setSource(const cv::UMat& gray) {
+        CV_Assert(gray.type() == CV_8UC1);
+        src_ = gray;
+    }
+
+    std::vector<MatchHit> match() {
+        std::vector<MatchHit> hits;
+        int nT = (int)sizes_.size();
+        if (nT == 0 || src_.empty())
+            return hits;
+
+        // tile grid covers the largest result map, smaller ones early-out
+        int maxCols = std::max(src_.cols - minW_ + 1, 1);
+        int maxRows = std::max(src_.rows - minH_ + 1, 1);
+        int groupsX = (maxCols + tile_ - 1) / tile_;
+        int groupsY = (maxRows + tile_ - 1) / tile_;
+        int groupsPerTempl = groupsX * groupsY;
+        size_t partCount = (size_t)nT * groupsPerTempl * 2;
+        if (partVal_.total() != partCount) {
+            partVal_.create(1, (int)partCount, CV_32FC1);
+            partIdx_.create(1, (int)partCount, CV_32SC1);
+        }
+        outVal_.create(1, nT * 2, CV_32FC1);
+        outIdx_.create(1, nT * 2, CV_32SC1);
+
+        // a cv::ocl::Kernel cannot be run again after an async run: one per
+        // launch, the program comes from OpenCV's cache
+        cv::ocl::Kernel matchKernel("matchBatch", source_, opts_);
+        matchKernel.args(cv::ocl::KernelArg::ReadOnly(src_),
+                         cv::ocl::KernelArg::ReadOnlyNoSize(atlas_),
+                         cv::ocl::KernelArg::PtrReadOnly(desc_),
+                         cv::ocl::KernelArg::PtrReadOnly(stats_),
+                         method_, groupsX, groupsPerTempl,
+                         cv::ocl::KernelArg::PtrWriteOnly(partVal_),
+                         cv::ocl::KernelArg::PtrWriteOnly(partIdx_));
+        size_t global[3] = {(size_t)groupsX * tile_, (size_t)groupsY * tile_, (size_t)nT};
+        size_t local[3] = {(size_t)tile_, (size_t)tile_, 1};
+        if (matchKernel.empty() || !matchKernel.run(3, global, local, false)) {
+            throw std::runtime_error("matchBatch launch failed");
+        }
+
+        cv::ocl::Kernel reduceKernel("reduceBatch", source_, opts_);
+        reduceKernel.args(cv::ocl::KernelArg::PtrReadOnly(partVal_),
+                          cv::ocl::KernelArg::PtrReadOnly(partIdx_),
+                          groupsPerTempl,
+                          cv::ocl::KernelArg::PtrWriteOnly(outVal_),
+                          cv::ocl::KernelArg::PtrWriteOnly(outIdx_));
+        size_t rglobal[1] = {(size_t)nT * redWg_};
+        size_t rlocal[1] = {(size_t)redWg_};
+        if (reduceKernel.empty() || !reduceKernel.run(1, rglobal, rlocal, false)) {
+            throw std::runtime_error("reduceBatch launch failed");
+        }
+
+        // the only device -> host traffic: 2 values + 2 indices per template
+        cv::Mat vals, idxs;
+        outVal_.copyTo(vals);
+        outIdx_.copyTo(idxs);
+        bool useMin = isSqdiff(method_);
+        for (int t = 0; t < nT; ++t) {
+            int k = 2 * t + (useMin ? 0 : 1);
+            int idx = idxs.at<int>(0, k);
+            int rcols = src_.cols - sizes_[t].width + 1;
+            MatchHit hit;
+            hit.templ = t;
+            hit.score = vals.at<float>(0, k);
+            hit.loc = idx >= 0 ? cv::Point(idx % rcols, idx / rcols) : cv::Point(-1, -1);
+            hits.push_back(hit);
+        }
+        return hits;
+    }
+
+    int method() const { return method_; }
+
+private:
+    int method_;
+    int tile_ = 16;
+    int redWg_ = 256;
+    int minW_ = 0, minH_ = 0;
+    std::vector<cv::Size> sizes_;
+    cv::ocl::ProgramSource source_;
+    std::string opts_;
+    cv::UMat src_, atlas_, desc_, stats_;
+    cv::UMat partVal_, partIdx_, outVal_, outIdx_;
+};
@@ -0,0 +1,5 @@
+#!/usr/bin/bash
+
+target_file=$1
+
+g++ $target_file -o app -std=c++17 -O2 -pthread -I/usr/local/include/opencv4 -L/usr/local/lib -lopencv_core -lopencv_imgproc -lopencv_highgui -lopencv_imgcodecs -lopencv_videoio -lOpenCL
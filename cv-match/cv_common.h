@@ -0,0 +1,134 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/ocl.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define SRC_IMG "moon.jpg"
+#define TMP_IMG "moon-2.jpg"
+
+// same OpenCL bring-up as test_cv.cpp, quiet unless asked
+static void initOpenCL(bool verbose = true) {
+    std::vector<cv::ocl::PlatformInfo> plats;
+    cv::ocl::getPlatfomsInfo(plats);
+    if (verbose && !plats.empty()) {
+        const cv::ocl::PlatformInfo* platform = &plats[0];
+        std::cout << "Platform name: " << platform->name().c_str() << std::endl;
+        cv::ocl::Device current_device;
+        platform->getDevice(current_device, 0);
+        std::cout << "Device name: " << current_device.name().c_str() << std::endl;
+        std::cout << "is_have_opencl:" << cv::ocl::haveOpenCL() << std::endl;
+        std::cout << "is_have_svm:" << cv::ocl::haveSVM() << std::endl;
+    }
+    cv::ocl::setUseOpenCL(true);
+}
+
+static bool isSqdiff(int method) {
+    return method == cv::TM_SQDIFF || method == cv::TM_SQDIFF_NORMED;
+}
+
+// best location for a method, same switch as runMatchGrayUseCpu
+static cv::Point matchPoint(int method, const cv::Point& minLoc, const cv::Point& maxLoc) {
+    return isSqdiff(method) ? minLoc : maxLoc;
+}
+
+static const char* methodName(int method) {
+    switch (method) {
+    case cv::TM_SQDIFF: return "TM_SQDIFF";
+    case cv::TM_SQDIFF_NORMED: return "TM_SQDIFF_NORMED";
+    case cv::TM_CCORR: return "TM_CCORR";
+    case cv::TM_CCORR_NORMED: return "TM_CCORR_NORMED";
+    case cv::TM_CCOEFF: return "TM_CCOEFF";
+    case cv::TM_CCOEFF_NORMED: return "TM_CCOEFF_NORMED";
+    default: return "unknown";
+    }
+}
+
+// p in (0, 1], nearest-rank: the smallest sample with at least p * n samples
+// at or below it
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty())
+        return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)std::ceil(p * v.size());
+    return v[std::min(std::max<size_t>(rank, 1), v.size()) - 1];
+}
+
+static double elapsedSeconds(double startTicks) {
+    return ((double)cv::getTickCount() - startTicks) / cv::getTickFrequency();
+}
+
+template <typename M>
+static void toGray(const M& src, M& gray) {
+    if (src.channels() == 1) gray = src;
+    else cv::cvtColor(src, gray, cv::COLOR_RGB2GRAY);
+}
+
+static cv::Mat loadGray(const std::string& path) {
+    cv::Mat img = cv::imread(path, cv::IMREAD_COLOR);
+    if (img.empty()) {
+        throw std::runtime_error("Failed to read image " + path);
+    }
+    cv::Mat gray;
+    toGray(img, gray);
+    return gray;
+}
+
+// template statistics shared by the custom matching kernels
+struct TemplStats {
+    float sumT2;   // sum(T^2)
+    float meanT;   // mean(T)
+    float normT;   // sum((T - meanT)^2)
+};
+
+static TemplStats templStats(const cv::Mat& tmpl) {
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(tmpl, mean, stddev);
+    double area = (double)tmpl.total();
+    TemplStats s;
+    s.sumT2 = (float)tmpl.dot(tmpl);
+    s.meanT = (float)mean[0];
+    s.normT = (float)(stddev[0] * stddev[0] * area);
+    return s;
+}
+
+// OpenCL snippet: score of one window from its running sums, following the
+// TM_* formulas of cv::matchTemplate. sD2 = sum((I-T)^2) is accumulated
+// directly so TM_SQDIFF does not cancel large numbers in float.
+static const char* matchScoreSource = R"(
+    #define TM_SQDIFF        0
+    #define TM_SQDIFF_NORMED 1
+    #define TM_CCORR         2
+    #define TM_CCORR_NORMED  3
+    #define TM_CCOEFF        4
+    #define TM_CCOEFF_NORMED 5
+
+    inline float matchScore(int method, float sIT, float sI, float sI2, float sD2,
+                            float sT2, float meanT, float normT, float area)
+    {
+        float num, den;
+        switch (method) {
+        case TM_SQDIFF:
+            return sD2;
+        case TM_SQDIFF_NORMED:
+            den = sqrt(sI2 * sT2);
+            return den > FLT_EPSILON ? sD2 / den : 1.f;
+        case TM_CCORR:
+            return sIT;
+        case TM_CCORR_NORMED:
+            den = sqrt(sI2 * sT2);
+            return den > FLT_EPSILON ? sIT / den : 0.f;
+        case TM_CCOEFF:
+            return sIT - sI * meanT;
+        default:
+            num = sIT - sI * meanT;
+            den = sqrt(max(normT * (sI2 - sI * sI / area), 0.f));
+            return den > FLT_EPSILON ? num / den : 0.f;
+        }
+    }
+)";
@@ -0,0 +1,345 @@
+#pragma once
+
+// Frequency-domain template matching on the GPU.
+//
+// Direct correlation costs O(result area * template area), so big templates
+// (moon-2.jpg cut out of moon.jpg) dominate. FftMatcher computes
+//     corr = IFFT(FFT(I) * conj(FFT(T)))
+// with mixed-radix (2/3/4/5) Stockham kernels, and turns it into any TM_*
+// score with window sums of I and I^2 (unanchored boxFilter).
+//
+//   - the source spectrum is computed once in setSource() and reused for
+//     every template; prepare() caches a template spectrum across frames
+//   - sources larger than maxFftDim are split into overlap-save tiles of
+//     tileFftDim, tiles overlap by maxTemplDim - 1 so every valid output
+//     lands in exactly one tile
+//   - preferFft() is the cost model used to pick direct vs FFT; matchAuto()
+//     dispatches on it to cv::matchTemplate or the FFT path
+
+#include "cv_common.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const char* fftMatchSource = R"(
+    #define MAX_RADIX 5
+
+    __kernel void packReal(__global const uchar* src, int src_step, int src_offset, int src_rows, int src_cols,
+                           int x0, int y0, int n_x, int n_y, __global float2* out)
+    {
+        int x = get_global_id(0);
+        int y = get_global_id(1);
+        if (x >= n_x || y >= n_y)
+            return;
+        int sx = x0 + x;
+        int sy = y0 + y;
+        float v = 0.f;
+        if (sx < src_cols && sy < src_rows)
+            v = (float)src[src_offset + sy * src_step + sx];
+        out[y * n_x + x] = (float2)(v, 0.f);
+    }
+
+    inline float2 cmul(float2 a, float2 b)
+    {
+        return (float2)(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+    }
+
+    inline float2 twiddle(float angle)
+    {
+        float c;
+        float s = sincos(angle, &c);
+        return (float2)(c, s);
+    }
+
+    // one Stockham pass of radix R over a batch of 1D transforms of length n.
+    // ns is the product of the radices already applied, dir -1 fwd / +1 inv.
+    __kernel void fftPass(__global const float2* in, __global float2* out,
+                          int n, int R, int ns, int elem_stride, int batch_stride, float dir)
+    {
+        int j = get_global_id(0);
+        int b = get_global_id(1);
+        int m = n / R;
+        if (j >= m)
+            return;
+        __global const float2* src = in + b * batch_stride;
+        __global float2* dst = out + b * batch_stride;
+
+        float2 v[MAX_RADIX];
+        int k = j % ns;
+        float angle = dir * 2.0f * M_PI_F * (float)k / (float)(ns * R);
+        for (int r = 0; r < R; ++r)
+            v[r] = cmul(src[(j + r * m) * elem_stride], twiddle(angle * r));
+
+        int base = (j / ns) * ns * R + k;
+        for (int q = 0; q < R; ++q) {
+            float2 acc = (float2)(0.f, 0.f);
+            for (int r = 0; r < R; ++r)
+                acc += cmul(v[r], twiddle(dir * 2.0f * M_PI_F * (float)((r * q) % R) / (float)R));
+            dst[(base + q * ns) * elem_stride] = acc;
+        }
+    }
+
+    __kernel void mulConj(__global const float2* a, __global const float2* b, __global float2* out, int n)
+    {
+        int i = get_global_id(0);
+        if (i >= n)
+            return;
+        float2 x = a[i];
+        float2 y = b[i];
+        out[i] = (float2)(x.x * y.x + x.y * y.y, x.y * y.x - x.x * y.y);
+    }
+
+    // turn one tile of correlation into scores, using window sums of I and I^2
+    __kernel void combine(__global const float2* corr, int n_x, float scale,
+                          int ox, int oy, int cw, int ch,
+                          __global const uchar* sum_ptr, int sum_step, int sum_offset,
+                          __global const uchar* sq_ptr, int sq_step, int sq_offset,
+                          float sT2, float meanT, float normT, float area, int method,
+                          __global uchar* res_ptr, int res_step, int res_offset, int res_rows, int res_cols)
+    {
+        int x = get_global_id(0);
+        int y = get_global_id(1);
+        int rx = ox + x;
+        int ry = oy + y;
+        if (x >= cw || y >= ch || rx >= res_cols || ry >= res_rows)
+            return;
+        float sIT = corr[y * n_x + x].x * scale;
+        float sI = *(__global const float*)(sum_ptr + sum_offset + ry * sum_step + rx * 4);
+        float sI2 = *(__global const float*)(sq_ptr + sq_offset + ry * sq_step + rx * 4);
+        float sD2 = max(sI2 - 2.f * sIT + sT2, 0.f);
+        *(__global float*)(res_ptr + res_offset + ry * res_step + rx * 4) =
+            matchScore(method, sIT, sI, sI2, sD2, sT2, meanT, normT, area);
+    }
+)";
+
+class FftMatcher {
+public:
+    struct TemplateSpectrum {
+        cv::UMat spec;       // CV_32FC2, plan nx_ x ny_
+        cv::Size size;
+        TemplStats stats;
+        int planId = -1;
+    };
+
+    // sources up to maxFftDim per side use a single transform, bigger ones
+    // are tiled with tileFftDim transforms supporting templates <= maxTemplDim
+    explicit FftMatcher(int maxFftDim = 4096, int tileFftDim = 2048, int maxTemplDim = 512)
+        : maxFftDim_(maxFftDim), tileFftDim_(cv::getOptimalDFTSize(tileFftDim)), maxTemplDim_(maxTemplDim),
+          source_(std::string(matchScoreSource) + fftMatchSource) {
+        if (maxTemplDim_ >= tileFftDim_) {
+            throw std::runtime_error("FftMatcher: maxTemplDim must be smaller than tileFftDim");
+        }
+    }
+
+    void setSource(const cv::UMat& gray) {
+        CV_Assert(gray.type() == CV_8UC1);
+        src_ = gray;
+        ax_ = planAxis(gray.cols);
+        ay_ = planAxis(gray.rows);
+        planId_++;
+
+        // float copies for the window sums, shared by all templates
+        gray.convertTo(srcF_, CV_32F);
+        cv::multiply(srcF_, srcF_, srcSq_);
+
+        tiles_.clear();
+        for (int ty = 0; ty < ay_.tiles; ++ty) {
+            for (int tx = 0; tx < ax_.tiles; ++tx) {
+                cv::UMat spec;
+                pack(src_, tx * ax_.step, ty * ay_.step, spec);
+                fft2d(spec, -1.f);
+                tiles_.push_back(spec);
+            }
+        }
+    }
+
+    TemplateSpectrum prepare(const cv::UMat& tmpl) {
+        CV_Assert(tmpl.type() == CV_8UC1 && !src_.empty());
+        if (!fits(tmpl.size())) {
+            throw std::runtime_error("FftMatcher: template too large for the tile plan");
+        }
+        TemplateSpectrum ts;
+        ts.size = tmpl.size();
+        ts.stats = templStats(tmpl.getMat(cv::ACCESS_READ));
+        pack(tmpl, 0, 0, ts.spec);
+        fft2d(ts.spec, -1.f);
+        ts.planId = planId_;
+        return ts;
+    }
+
+    void match(const TemplateSpectrum& ts, int method, cv::UMat& result) {
+        if (ts.planId != planId_) {
+            throw std::runtime_error("FftMatcher: template spectrum belongs to another source");
+        }
+        int tw = ts.size.width, th = ts.size.height;
+        int rcols = src_.cols - tw + 1;
+        int rrows = src_.rows - th + 1;
+        result.create(rrows, rcols, CV_32FC1);
+
+        // top-left anchored window sums of I and I^2
+        cv::boxFilter(srcF_, sumI_, CV_32F, ts.size, cv::Point(0, 0), false);
+        cv::boxFilter(srcSq_, sumI2_, CV_32F, ts.size, cv::Point(0, 0), false);
+
+        int n = ax_.n * ay_.n;
+        float scale = 1.f / (float)n;
+        work_.create(ay_.n, ax_.n, CV_32FC2);
+        for (int ty = 0; ty < ay_.tiles; ++ty) {
+            for (int tx = 0; tx < ax_.tiles; ++tx) {
+                int ox = tx * ax_.step, oy = ty * ay_.step;
+                if (ox >= rcols || oy >= rrows)
+                    continue;
+                const cv::UMat& spec = tiles_[ty * ax_.tiles + tx];
+
+                cv::ocl::Kernel mul("mulConj", source_);
+                mul.args(cv::ocl::KernelArg::PtrReadOnly(spec), cv::ocl::KernelArg::PtrReadOnly(ts.spec),
+                         cv::ocl::KernelArg::PtrWriteOnly(work_), n);
+                size_t g1[1] = {(size_t)n};
+                runOrThrow(mul, 1, g1, "mulConj");
+
+                fft2d(work_, 1.f);
+
+                int cw = std::min(ax_.step, rcols - ox);
+                int ch = std::min(ay_.step, rrows - oy);
+                cv::ocl::Kernel comb("combine", source_);
+                comb.args(cv::ocl::KernelArg::PtrReadOnly(work_), ax_.n, scale, ox, oy, cw, ch,
+                          cv::ocl::KernelArg::ReadOnlyNoSize(sumI_), cv::ocl::KernelArg::ReadOnlyNoSize(sumI2_),
+                          ts.stats.sumT2, ts.stats.meanT, ts.stats.normT, (float)(tw * th), method,
+                          cv::ocl::KernelArg::ReadWrite(result));
+                size_t g2[2] = {(size_t)cw, (size_t)ch};
+                runOrThrow(comb, 2, g2, "combine");
+            }
+        }
+    }
+
+    void match(const cv::UMat& tmpl, int method, cv::UMat& result) {
+        match(prepare(tmpl), method, result);
+    }
+
+    bool fits(cv::Size tmpl) const {
+        if (tmpl.width > src_.cols || tmpl.height > src_.rows)
+            return false;
+        return (ax_.tiles == 1 || tmpl.width <= maxTemplDim_) && (ay_.tiles == 1 || tmpl.height <= maxTemplDim_);
+    }
+
+    int tiles() const { return ax_.tiles * ay_.tiles; }
+    cv::Size fftSize() const { return cv::Size(ax_.n, ay_.n); }
+
+    // rough flop counts; the source spectrum is cached so an FFT match costs
+    // a template transform, a product, an inverse transform per tile and the
+    // two window sums. Direct costs a MAC per template pixel per output.
+    static double costDirect(cv::Size src, cv::Size tmpl) {
+        double rc = src.width - tmpl.width + 1, rr = src.height - tmpl.height + 1;
+        return 2.0 * rc * rr * tmpl.width * tmpl.height;
+    }
+
+    double costFft(cv::Size tmpl) const {
+        double n = (double)ax_.n * ay_.n;
+        double fft = 5.0 * n * std::log2(n);
+        double perTile = fft + 6.0 * n;
+        return fft + tiles() * perTile + 4.0 * src_.total() * 2;
+    }
+
+    // FFT kernels are memory bound, weight them against the direct MACs
+    bool preferFft(cv::Size tmpl, double fftPenalty = 4.0) const {
+        return fits(tmpl) && costFft(tmpl) * fftPenalty < costDirect(src_.size(), tmpl);
+    }
+
+    // cv::matchTemplate on the source, or the FFT path when the cost model
+    // prefers it; `spec` (from prepare(tmpl)) saves the template transform.
+    // Returns true if the FFT path ran.
+    bool matchAuto(const cv::UMat& tmpl, int method, cv::UMat& result, const TemplateSpectrum* spec = nullptr,
+                   double fftPenalty = 4.0) {
+        CV_Assert(!src_.empty());
+        if (!preferFft(tmpl.size(), fftPenalty)) {
+            cv::matchTemplate(src_, tmpl, result, method);
+            return false;
+        }
+        if (spec)
+            match(*spec, method, result);
+        else
+            match(tmpl, method, result);
+        return true;
+    }
+
+private:
+    struct Axis {
+        int n = 1;       // transform length
+        int step = 1;    // tile stride in source pixels == outputs per tile
+        int tiles = 1;
+    };
+
+    Axis planAxis(int len) const {
+        Axis a;
+        int good = cv::getOptimalDFTSize(len);
+        if (good <= maxFftDim_) {
+            a.n = good;
+            a.step = len;
+            a.tiles = 1;
+        } else {
+            a.n = tileFftDim_;
+            a.step = tileFftDim_ - maxTemplDim_ + 1;
+            a.tiles = (len + a.step - 1) / a.step;
+        }
+        return a;
+    }
+
+    void pack(const cv::UMat& img, int x0, int y0, cv::UMat& out) {
+        out.create(ay_.n, ax_.n, CV_32FC2);
+        cv::ocl::Kernel k("packReal", source_);
+        k.args(cv::ocl::KernelArg::ReadOnly(img), x0, y0, ax_.n, ay_.n, cv::ocl::KernelArg::PtrWriteOnly(out));
+        size_t g[2] = {(size_t)ax_.n, (size_t)ay_.n};
+        runOrThrow(k, 2, g, "packReal");
+    }
+
+    // radices for n, largest first; getOptimalDFTSize only yields 2^a 3^b 5^c
+    static std::vector<int> factorize(int n) {
+        std::vector<int> f;
+        const int radices[] = {4, 2, 3, 5};
+        for (int r : radices) {
+            while (n % r == 0) {
+                f.push_back(r);
+                n /= r;
+            }
+        }
+        if (n != 1) {
+            throw std::runtime_error("FftMatcher: unsupported transform length");
+        }
+        return f;
+    }
+
+    void fftAxis(cv::UMat& data, int n, int batches, int elemStride, int batchStride, float dir) {
+        scratch_.create(data.rows, data.cols, CV_32FC2);
+        int ns = 1;
+        for (int R : factorize(n)) {
+            cv::ocl::Kernel k("fftPass", source_);
+            k.args(cv::ocl::KernelArg::PtrReadOnly(data), cv::ocl::KernelArg::PtrWriteOnly(scratch_),
+                   n, R, ns, elemStride, batchStride, dir);
+            size_t g[2] = {(size_t)(n / R), (size_t)batches};
+            runOrThrow(k, 2, g, "fftPass");
+            std::swap(data, scratch_);
+            ns *= R;
+        }
+    }
+
+    void fft2d(cv::UMat& data, float dir) {
+        fftAxis(data, ax_.n, ay_.n, 1, ax_.n, dir);     // rows
+        fftAxis(data, ay_.n, ax_.n, ax_.n, 1, dir);     // columns
+    }
+
+    static void runOrThrow(cv::ocl::Kernel& k, int dims, size_t* global, const char* name) {
+        if (k.empty() || !k.run(dims, global, nullptr, false)) {
+            throw std::runtime_error(std::string("FftMatcher: ") + name + " failed");
+        }
+    }
+
+    int maxFftDim_, tileFftDim_, maxTemplDim_;
+    // kernels are created per launch: a cv::ocl::Kernel cannot be run again
+    // after an async run, and OpenCV caches the built program
+    cv::ocl::ProgramSource source_;
+    cv::UMat src_, srcF_, srcSq_, sumI_, sumI2_, work_, scratch_;
+    std::vector<cv::UMat> tiles_;
+    Axis ax_, ay_;
+    int planId_ = 0;
+};
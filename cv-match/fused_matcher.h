@@ -0,0 +1,201 @@
+#pragma once
+
+// Fused color-convert + template-match + min/max-location.
+//
+// test_cv.cpp runs cvtColor, matchTemplate and minMaxLoc as three GPU passes,
+// writing a full gray frame and a full float result map to global memory and
+// reading both back. fusedMatch reads the BGR frame once: each work-group
+// converts its (tile + template - 1) halo to gray into local memory with the
+// same fixed-point weights as cv::COLOR_RGB2GRAY, scores its tile and keeps
+// only a min and a max candidate. reduceBatch from batch_matcher.h folds the
+// candidates, so the only global writes are a few bytes per work-group.
+
+#include "cv_common.h"
+#include "batch_matcher.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+static const char* fusedMatchSource = R"(
+    // cvtColor(COLOR_RGB2GRAY) fixed point: R2Y 4899, G2Y 9617, B2Y 1868, shift 14
+    inline uchar grayAt(__global const uchar* src, int src_step, int src_offset, int x, int y)
+    {
+        __global const uchar* p = src + src_offset + y * src_step + x * 3;
+        return (uchar)((p[0] * 4899 + p[1] * 9617 + p[2] * 1868 + (1 << 13)) >> 14);
+    }
+
+    __kernel void fusedMatch(__global const uchar* src, int src_step, int src_offset, int src_rows, int src_cols,
+                             __global const uchar* tpl, int tpl_step, int tpl_offset, int tpl_rows, int tpl_cols,
+                             float sT2, float meanT, float normT, int method, int groups_x,
+                             __global float* part_val, __global int* part_idx)
+    {
+        __local uchar tile[LOCAL_BYTES];
+        __local float lmin[TILE_X * TILE_Y];
+        __local float lmax[TILE_X * TILE_Y];
+        __local int imin[TILE_X * TILE_Y];
+        __local int imax[TILE_X * TILE_Y];
+
+        int lx = get_local_id(0);
+        int ly = get_local_id(1);
+        int lid = ly * TILE_X + lx;
+        int x = get_global_id(0);
+        int y = get_global_id(1);
+        int x0 = get_group_id(0) * TILE_X;
+        int y0 = get_group_id(1) * TILE_Y;
+        int tw = tpl_cols;
+        int th = tpl_rows;
+        int rcols = src_cols - tw + 1;
+        int rrows = src_rows - th + 1;
+
+        // gray halo in local memory when it fits, uniform per launch
+        int hw = TILE_X + tw - 1;
+        int hh = TILE_Y + th - 1;
+        bool use_local = hw * hh <= LOCAL_BYTES;
+        if (use_local) {
+            for (int k = lid; k < hw * hh; k += TILE_X * TILE_Y) {
+                int sx = x0 + k % hw;
+                int sy = y0 + k / hw;
+                tile[k] = (sx < src_cols && sy < src_rows) ? grayAt(src, src_step, src_offset, sx, sy) : 0;
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        float vmin = INFINITY, vmax = -INFINITY;
+        int idx = -1;
+        if (x < rcols && y < rrows) {
+            float sIT = 0.f, sI = 0.f, sI2 = 0.f, sD2 = 0.f;
+            for (int j = 0; j < th; ++j) {
+                __global const uchar* trow = tpl + tpl_offset + j * tpl_step;
+                for (int i = 0; i < tw; ++i) {
+                    float a = use_local ? tile[(ly + j) * hw + lx + i] : grayAt(src, src_step, src_offset, x + i, y + j);
+                    float b = trow[i];
+                    float d = a - b;
+                    sIT += a * b;
+                    sI += a;
+                    sI2 += a * a;
+                    sD2 += d * d;
+                }
+            }
+            float s = matchScore(method, sIT, sI, sI2, sD2, sT2, meanT, normT, (float)(tw * th));
+            vmin = vmax = s;
+            idx = y * rcols + x;
+        }
+        lmin[lid] = vmin; lmax[lid] = vmax;
+        imin[lid] = idx;  imax[lid] = idx;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int s = TILE_X * TILE_Y / 2; s > 0; s >>= 1) {
+            if (lid < s) {
+                if (BETTER_MIN(lmin[lid + s], imin[lid + s], lmin[lid], imin[lid])) {
+                    lmin[lid] = lmin[lid + s]; imin[lid] = imin[lid + s];
+                }
+                if (BETTER_MAX(lmax[lid + s], imax[lid + s], lmax[lid], imax[lid])) {
+                    lmax[lid] = lmax[lid + s]; imax[lid] = imax[lid + s];
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (lid == 0) {
+            int g = get_group_id(1) * groups_x + get_group_id(0);
+            part_val[2 * g] = lmin[0];
+            part_val[2 * g + 1] = lmax[0];
+            part_idx[2 * g] = imin[0];
+            part_idx[2 * g + 1] = imax[0];
+        }
+    }
+)";
+
+class FusedMatcher {
+public:
+    explicit FusedMatcher(int method = cv::TM_SQDIFF)
+        : method_(method), source_(std::string(matchScoreSource) + batchMatchSource + fusedMatchSource) {
+        cv::ocl::Device dev = cv::ocl::Device::getDefault();
+        size_t maxWg = dev.maxWorkGroupSize();
+        tile_ = maxWg >= 256 ? 16 : 8;
+        // the tree reduction in reduceBatch halves RED_WG: power of two
+        redWg_ = 1;
+        while ((size_t)redWg_ * 2 <= std::min<size_t>(256, maxWg))
+            redWg_ *= 2;
+        // leave room for the reduction arrays, cap the halo at 16 KB
+        size_t reduceBytes = (size_t)tile_ * tile_ * 16;
+        localBytes_ = (int)std::min<size_t>(16384, dev.localMemSize() > reduceBytes ? dev.localMemSize() - reduceBytes : 0);
+        localBytes_ = std::max(localBytes_, 1);
+        opts_ = cv::format("-D TILE_X=%d -D TILE_Y=%d -D RED_WG=%d -D LOCAL_BYTES=%d", tile_, tile_, redWg_,
+                           localBytes_);
+        // build once up front so errors show here; OpenCV caches the program
+        cv::ocl::Kernel fusedKernel("fusedMatch", source_, opts_), reduceKernel("reduceBatch", source_, opts_);
+        if (fusedKernel.empty() || reduceKernel.empty()) {
+            throw std::runtime_error("Failed to build fusedMatch kernels");
+        }
+    }
+
+    void setTemplate(const cv::Mat& gray_tmp) {
+        CV_Assert(gray_tmp.type() == CV_8UC1);
+        gray_tmp.copyTo(tmpl_);
+        stats_ = templStats(gray_tmp);
+    }
+
+    // src is the 3-channel frame as decoded, no cvtColor beforehand
+    MatchHit match(const cv::UMat& src) {
+        CV_Assert(src.type() == CV_8UC3 && !tmpl_.empty());
+        MatchHit hit{0, cv::Point(-1, -1), 0.f};
+        int rcols = src.cols - tmpl_.cols + 1;
+        int rrows = src.rows - tmpl_.rows + 1;
+        if (rcols <= 0 || rrows <= 0)
+            return hit;
+
+        int groupsX = (rcols + tile_ - 1) / tile_;
+        int groupsY = (rrows + tile_ - 1) / tile_;
+        int groups = groupsX * groupsY;
+        partVal_.create(1, 2 * groups, CV_32FC1);
+        partIdx_.create(1, 2 * groups, CV_32SC1);
+        outVal_.create(1, 2, CV_32FC1);
+        outIdx_.create(1, 2, CV_32SC1);
+
+        // a kernel run async can't be run again: fresh ones per match
+        cv::ocl::Kernel fusedKernel("fusedMatch", source_, opts_), reduceKernel("reduceBatch", source_, opts_);
+        fusedKernel.args(cv::ocl::KernelArg::ReadOnly(src), cv::ocl::KernelArg::ReadOnly(tmpl_), stats_.sumT2,
+                         stats_.meanT, stats_.normT, method_, groupsX, cv::ocl::KernelArg::PtrWriteOnly(partVal_),
+                         cv::ocl::KernelArg::PtrWriteOnly(partIdx_));
+        size_t global[2] = {(size_t)groupsX * tile_, (size_t)groupsY * tile_};
+        size_t local[2] = {(size_t)tile_, (size_t)tile_};
+        if (!fusedKernel.run(2, global, local, false)) {
+            throw std::runtime_error("fusedMatch launch failed");
+        }
+
+        reduceKernel.args(cv::ocl::KernelArg::PtrReadOnly(partVal_), cv::ocl::KernelArg::PtrReadOnly(partIdx_), groups,
+                          cv::ocl::KernelArg::PtrWriteOnly(outVal_), cv::ocl::KernelArg::PtrWriteOnly(outIdx_));
+        size_t rglobal[1] = {(size_t)redWg_};
+        size_t rlocal[1] = {(size_t)redWg_};
+        if (!reduceKernel.run(1, rglobal, rlocal, false)) {
+            throw std::runtime_error("reduceBatch launch failed");
+        }
+
+        // the only device -> host traffic: 2 values + 2 indices
+        cv::Mat vals, idxs;
+        outVal_.copyTo(vals);
+        outIdx_.copyTo(idxs);
+        int k = isSqdiff(method_) ? 0 : 1;
+        int idx = idxs.at<int>(0, k);
+        hit.score = vals.at<float>(0, k);
+        if (idx >= 0)
+            hit.loc = cv::Point(idx % rcols, idx / rcols);
+        return hit;
+    }
+
+    int localBytes() const { return localBytes_; }
+    // square work-group tile, one (min, max) partial per tile
+    int tile() const { return tile_; }
+
+private:
+    int method_;
+    int tile_ = 16;
+    int redWg_ = 256;
+    int localBytes_ = 16384;
+    cv::ocl::ProgramSource source_;
+    std::string opts_;
+    cv::UMat tmpl_, partVal_, partIdx_, outVal_, outIdx_;
+    TemplStats stats_{};
+};
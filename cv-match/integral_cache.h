@@ -0,0 +1,219 @@
+#pragma once
+
+// Integral-image cache for the normalized matching methods.
+//
+// TM_SQDIFF_NORMED, TM_CCORR_NORMED and TM_CCOEFF(_NORMED) need sum(I) and
+// sum(I^2) over every window. cv::matchTemplate recomputes them for each call,
+// i.e. once per template. IntegralCache builds the integral and squared
+// integral of a source once on the GPU (row prefix-sum in local memory, then a
+// column pass) and keeps them until the source changes, so each window costs
+// four lookups. NormalizedMatcher runs the plain TM_CCORR pass and folds the
+// cached window sums in with matchScore.
+//
+// Sums are kept as uint and sums of squares as ulong. Window sums are taken as
+// modular differences, so they stay exact even if a 4K integral wraps.
+
+#include "cv_common.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+static const char* integralSource = R"(
+    // one work-group per source row: inclusive scan of the row in WG chunks
+    __kernel void integralRows(__global const uchar* src, int src_step, int src_offset, int rows, int cols,
+                               __global uchar* sum_ptr, int sum_step, int sum_offset,
+                               __global uchar* sq_ptr, int sq_step, int sq_offset)
+    {
+        __local uint ls[WG];
+        __local ulong lq[WG];
+
+        int y = get_group_id(0);
+        int lid = get_local_id(0);
+        __global const uchar* s = src + src_offset + y * src_step;
+        __global uint* srow = (__global uint*)(sum_ptr + sum_offset + (y + 1) * sum_step);
+        __global ulong* qrow = (__global ulong*)(sq_ptr + sq_offset + (y + 1) * sq_step);
+        if (lid == 0) {
+            srow[0] = 0;
+            qrow[0] = 0;
+        }
+
+        uint carry = 0;
+        ulong qcarry = 0;
+        for (int base = 0; base < cols; base += WG) {
+            int x = base + lid;
+            uint v = x < cols ? s[x] : 0;
+            ls[lid] = v;
+            lq[lid] = (ulong)(v * v);
+            barrier(CLK_LOCAL_MEM_FENCE);
+
+            for (int off = 1; off < WG; off <<= 1) {
+                uint a = lid >= off ? ls[lid - off] : 0;
+                ulong b = lid >= off ? lq[lid - off] : 0;
+                barrier(CLK_LOCAL_MEM_FENCE);
+                ls[lid] += a;
+                lq[lid] += b;
+                barrier(CLK_LOCAL_MEM_FENCE);
+            }
+
+            if (x < cols) {
+                srow[x + 1] = carry + ls[lid];
+                qrow[x + 1] = qcarry + lq[lid];
+            }
+            carry += ls[WG - 1];
+            qcarry += lq[WG - 1];
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    }
+
+    // one work-item per integral column, accumulates down the rows
+    __kernel void integralCols(__global uchar* sum_ptr, int sum_step, int sum_offset,
+                               __global uchar* sq_ptr, int sq_step, int sq_offset, int rows, int cols)
+    {
+        int x = get_global_id(0);
+        if (x > cols)
+            return;
+
+        __global uchar* sp = sum_ptr + sum_offset + x * (int)sizeof(uint);
+        __global uchar* qp = sq_ptr + sq_offset + x * (int)sizeof(ulong);
+        *(__global uint*)sp = 0;
+        *(__global ulong*)qp = 0;
+        uint acc = 0;
+        ulong qacc = 0;
+        for (int y = 1; y <= rows; ++y) {
+            __global uint* s = (__global uint*)(sp + y * sum_step);
+            __global ulong* q = (__global ulong*)(qp + y * sq_step);
+            acc += *s;
+            qacc += *q;
+            *s = acc;
+            *q = qacc;
+        }
+    }
+
+    // in place: TM_CCORR result -> `method` score using the cached window sums
+    __kernel void normalizeMatch(__global uchar* res, int res_step, int res_offset, int rrows, int rcols,
+                                 __global const uchar* sum_ptr, int sum_step, int sum_offset,
+                                 __global const uchar* sq_ptr, int sq_step, int sq_offset,
+                                 int tw, int th, float sT2, float meanT, float normT, int method)
+    {
+        int x = get_global_id(0);
+        int y = get_global_id(1);
+        if (x >= rcols || y >= rrows)
+            return;
+
+        #define SUM(r, c) (*(__global const uint*)(sum_ptr + sum_offset + (r) * sum_step + (c) * (int)sizeof(uint)))
+        #define SQ(r, c) (*(__global const ulong*)(sq_ptr + sq_offset + (r) * sq_step + (c) * (int)sizeof(ulong)))
+        uint s = SUM(y + th, x + tw) - SUM(y, x + tw) - SUM(y + th, x) + SUM(y, x);
+        ulong q = SQ(y + th, x + tw) - SQ(y, x + tw) - SQ(y + th, x) + SQ(y, x);
+        #undef SUM
+        #undef SQ
+
+        __global float* r = (__global float*)(res + res_offset + y * res_step) + x;
+        float sIT = *r;
+        float sI = (float)s;
+        float sI2 = (float)q;
+        float sD2 = max(sI2 - 2.f * sIT + sT2, 0.f);
+        *r = matchScore(method, sIT, sI, sI2, sD2, sT2, meanT, normT, (float)(tw * th));
+    }
+)";
+
+class IntegralCache {
+public:
+    IntegralCache() : source_(std::string(matchScoreSource) + integralSource) {
+        wg_ = (int)std::min<size_t>(256, cv::ocl::Device::getDefault().maxWorkGroupSize());
+        opts_ = cv::format("-D WG=%d", wg_);
+        // build once up front so errors show here; OpenCV caches the program
+        cv::ocl::Kernel rowsKernel("integralRows", source_, opts_), colsKernel("integralCols", source_, opts_);
+        if (rowsKernel.empty() || colsKernel.empty()) {
+            throw std::runtime_error("Failed to build integral kernels");
+        }
+    }
+
+    // Rebuilds only when `gray` is not the cached source. The cache holds a
+    // reference to the source, so its buffer cannot be freed and handed out
+    // again under the same address. A UMat overwritten in place (streaming
+    // into the same buffer) looks unchanged: call invalidate().
+    bool update(const cv::UMat& gray) {
+        CV_Assert(gray.type() == CV_8UC1);
+        if (!src_.empty() && gray.u == src_.u && gray.offset == src_.offset && gray.size() == src_.size() &&
+            gray.step[0] == src_.step[0])
+            return false;
+
+        sum_.create(gray.rows + 1, gray.cols + 1, CV_32SC1);
+        sqsum_.create(gray.rows + 1, gray.cols + 1, CV_32SC2);   // 8-byte ulong per element
+
+        // a kernel run async can't be run again: fresh ones per build
+        cv::ocl::Kernel rowsKernel("integralRows", source_, opts_), colsKernel("integralCols", source_, opts_);
+        rowsKernel.args(cv::ocl::KernelArg::ReadOnly(gray),
+                        cv::ocl::KernelArg::WriteOnlyNoSize(sum_),
+                        cv::ocl::KernelArg::WriteOnlyNoSize(sqsum_));
+        size_t rglobal[1] = {(size_t)gray.rows * wg_};
+        size_t rlocal[1] = {(size_t)wg_};
+        if (!rowsKernel.run(1, rglobal, rlocal, false)) {
+            throw std::runtime_error("integralRows launch failed");
+        }
+
+        colsKernel.args(cv::ocl::KernelArg::ReadWriteNoSize(sum_),
+                        cv::ocl::KernelArg::ReadWriteNoSize(sqsum_),
+                        gray.rows, gray.cols);
+        size_t cglobal[1] = {(size_t)(gray.cols + 1 + wg_ - 1) / wg_ * wg_};
+        size_t clocal[1] = {(size_t)wg_};
+        if (!colsKernel.run(1, cglobal, clocal, false)) {
+            throw std::runtime_error("integralCols launch failed");
+        }
+
+        src_ = gray;
+        builds_++;
+        return true;
+    }
+
+    // also drops the reference to the source
+    void invalidate() { src_.release(); }
+
+    bool valid() const { return !src_.empty(); }
+    size_t builds() const { return builds_; }
+    const cv::UMat& sum() const { return sum_; }
+    const cv::UMat& sqsum() const { return sqsum_; }
+
+private:
+    int wg_ = 256;
+    cv::ocl::ProgramSource source_;
+    std::string opts_;
+    cv::UMat sum_, sqsum_;
+    cv::UMat src_;   // cached source, empty when invalid
+    size_t builds_ = 0;
+};
+
+class NormalizedMatcher {
+public:
+    NormalizedMatcher() : source_(std::string(matchScoreSource) + integralSource) {
+        if (cv::ocl::Kernel("normalizeMatch", source_, "-D WG=1").empty()) {
+            throw std::runtime_error("Failed to build normalizeMatch kernel");
+        }
+    }
+
+    IntegralCache& cache() { return cache_; }
+
+    // same result as cv::matchTemplate(src, tmpl, result, method)
+    void match(const cv::UMat& src, const cv::UMat& tmpl, const TemplStats& stats, int method, cv::UMat& result) {
+        CV_Assert(src.type() == CV_8UC1 && tmpl.type() == CV_8UC1);
+        cv::matchTemplate(src, tmpl, result, cv::TM_CCORR);
+        if (method == cv::TM_CCORR)
+            return;
+        cache_.update(src);
+
+        cv::ocl::Kernel normKernel("normalizeMatch", source_, "-D WG=1");
+        normKernel.args(cv::ocl::KernelArg::ReadWrite(result),
+                        cv::ocl::KernelArg::ReadOnlyNoSize(cache_.sum()),
+                        cv::ocl::KernelArg::ReadOnlyNoSize(cache_.sqsum()),
+                        tmpl.cols, tmpl.rows, stats.sumT2, stats.meanT, stats.normT, method);
+        size_t global[2] = {(size_t)result.cols, (size_t)result.rows};
+        if (!normKernel.run(2, global, NULL, false)) {
+            throw std::runtime_error("normalizeMatch launch failed");
+        }
+    }
+
+private:
+    IntegralCache cache_;
+    cv::ocl::ProgramSource source_;
+};
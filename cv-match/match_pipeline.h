@@ -0,0 +1,228 @@
+#pragma once
+
+// Asynchronous decode -> upload -> match pipeline.
+//
+//   decoder pool --q--> upload (pinned) --q--> GPU match --q--> result sink
+//
+// Stages are connected by bounded queues, so decoding of frame i+2, upload of
+// i+1 and matching of i overlap while memory stays bounded. The upload stage
+// copies into a CL_MEM_ALLOC_HOST_PTR (pinned) UMat and lets the driver DMA
+// it into a device UMat. OpenCV queues are per thread, so each stage finishes
+// its own queue before handing a UMat downstream.
+
+#include "cv_common.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    // false if the queue was closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_)
+            return false;
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    // false once the queue is closed and drained
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty())
+            return false;
+        item = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    size_t capacity_;
+    bool closed_ = false;
+    std::deque<T> items_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_, notFull_;
+};
+
+struct PipelineFrame {
+    int index = -1;
+    std::string name;
+    cv::Mat decoded;
+    cv::UMat device;
+    cv::Point loc;
+    double score = 0.0;
+};
+
+// busy time of one stage, summed over its threads
+struct StageStats {
+    std::atomic<long long> busyTicks{0};
+    std::atomic<int> items{0};
+    int threads = 1;
+
+    void add(double startTicks) {
+        busyTicks += (long long)((double)cv::getTickCount() - startTicks);
+        items++;
+    }
+
+    double utilization(double wallSeconds) const {
+        double busy = (double)busyTicks.load() / cv::getTickFrequency();
+        return wallSeconds > 0 ? busy / (wallSeconds * threads) : 0.0;
+    }
+};
+
+class MatchPipeline {
+public:
+    // sources: image paths, or a single video path when isVideo
+    MatchPipeline(const std::vector<std::string>& sources, bool isVideo, const cv::Mat& gray_tmp,
+                  int method = cv::TM_SQDIFF, int decoders = 2, size_t depth = 2)
+        : sources_(sources), isVideo_(isVideo), tmpl_(gray_tmp), method_(method),
+          decoders_(isVideo ? 1 : std::max(decoders, 1)),
+          decoded_(depth), uploaded_(depth), matched_(depth) {
+        decode_.threads = decoders_;
+    }
+
+    // runs to completion, results ordered by frame index
+    std::vector<PipelineFrame> run() {
+        std::vector<PipelineFrame> results;
+        double start = (double)cv::getTickCount();
+
+        std::atomic<int> next{0};
+        std::atomic<int> running{decoders_};
+        std::vector<std::thread> decoders;
+        for (int d = 0; d < decoders_; ++d) {
+            decoders.emplace_back([&] {
+                if (isVideo_) decodeVideo();
+                else decodeImages(next);
+                if (--running == 0)
+                    decoded_.close();
+            });
+        }
+        std::thread uploader([this] { uploadLoop(); });
+        std::thread matcher([this] { matchLoop(); });
+
+        // result sink on the calling thread
+        PipelineFrame f;
+        while (matched_.pop(f)) {
+            f.decoded.release();
+            f.device.release();
+            results.push_back(std::move(f));
+        }
+
+        for (auto& t : decoders)
+            t.join();
+        uploader.join();
+        matcher.join();
+        wall_ = elapsedSeconds(start);
+
+        std::sort(results.begin(), results.end(),
+                  [](const PipelineFrame& a, const PipelineFrame& b) { return a.index < b.index; });
+        return results;
+    }
+
+    double wallSeconds() const { return wall_; }
+    const StageStats& decodeStats() const { return decode_; }
+    const StageStats& uploadStats() const { return upload_; }
+    const StageStats& matchStats() const { return match_; }
+
+private:
+    void decodeImages(std::atomic<int>& next) {
+        for (int i = next++; i < (int)sources_.size(); i = next++) {
+            double t = (double)cv::getTickCount();
+            PipelineFrame f;
+            f.index = i;
+            f.name = sources_[i];
+            f.decoded = cv::imread(sources_[i], cv::IMREAD_COLOR);
+            decode_.add(t);
+            if (f.decoded.empty())
+                continue;
+            if (!decoded_.push(std::move(f)))
+                return;
+        }
+    }
+
+    void decodeVideo() {
+        cv::VideoCapture cap(sources_.empty() ? std::string() : sources_[0]);
+        for (int i = 0;; ++i) {
+            double t = (double)cv::getTickCount();
+            PipelineFrame f;
+            f.index = i;
+            if (!cap.read(f.decoded))
+                break;
+            decode_.add(t);
+            if (!decoded_.push(std::move(f)))
+                return;
+        }
+    }
+
+    void uploadLoop() {
+        cv::UMat pinned;
+        PipelineFrame f;
+        while (decoded_.pop(f)) {
+            double t = (double)cv::getTickCount();
+            if (pinned.size() != f.decoded.size() || pinned.type() != f.decoded.type())
+                pinned = cv::UMat(f.decoded.size(), f.decoded.type(), cv::USAGE_ALLOCATE_HOST_MEMORY);
+            {
+                cv::Mat host = pinned.getMat(cv::ACCESS_WRITE);
+                f.decoded.copyTo(host);
+            }
+            f.device = cv::UMat(f.decoded.size(), f.decoded.type(), cv::USAGE_ALLOCATE_DEVICE_MEMORY);
+            pinned.copyTo(f.device);
+            cv::ocl::finish();
+            f.decoded.release();
+            upload_.add(t);
+            if (!uploaded_.push(std::move(f)))
+                break;
+        }
+        uploaded_.close();
+    }
+
+    void matchLoop() {
+        cv::UMat utmp, gray, result;
+        tmpl_.copyTo(utmp);
+        PipelineFrame f;
+        while (uploaded_.pop(f)) {
+            double t = (double)cv::getTickCount();
+            toGray(f.device, gray);
+            cv::matchTemplate(gray, utmp, result, method_);
+            double minVal, maxVal;
+            cv::Point minLoc, maxLoc;
+            cv::minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+            cv::ocl::finish();
+            f.loc = matchPoint(method_, minLoc, maxLoc);
+            f.score = isSqdiff(method_) ? minVal : maxVal;
+            match_.add(t);
+            if (!matched_.push(std::move(f)))
+                break;
+        }
+        matched_.close();
+    }
+
+    std::vector<std::string> sources_;
+    bool isVideo_;
+    cv::Mat tmpl_;
+    int method_;
+    int decoders_;
+    BoundedQueue<PipelineFrame> decoded_, uploaded_, matched_;
+    StageStats decode_, upload_, match_;
+    double wall_ = 0.0;
+};
@@ -0,0 +1,247 @@
+#pragma once
+
+// Coarse-to-fine template search.
+//
+// Image and template pyramids are built on the device once (cv::pyrDown on
+// UMat). The coarsest level is matched exhaustively, the best `candidates`
+// locations (with non-maximum suppression) are kept, and every finer level
+// only evaluates a (2*radius+1)^2 window around each up-scaled candidate in a
+// single refineCandidates launch, one work-group per candidate.
+
+#include "cv_common.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <string>
+#include <vector>
+
+static const char* pyramidMatchSource = R"(
+    // sqdiff methods look for the minimum, ties go to the lower index
+    inline bool better(float a, int ia, float b, int ib, int is_min)
+    {
+        if (ia < 0) return false;
+        if (ib < 0) return true;
+        if (a == b) return ia < ib;
+        return is_min ? a < b : a > b;
+    }
+
+    __kernel void refineCandidates(__global const uchar* src, int src_step, int src_offset, int src_rows, int src_cols,
+                                   __global const uchar* tpl, int tpl_step, int tpl_offset, int tpl_rows, int tpl_cols,
+                                   __global const int* cand, int radius, int method,
+                                   float sT2, float meanT, float normT,
+                                   __global float* out_val, __global int* out_pos)
+    {
+        __local float lval[WG];
+        __local int lpos[WG];
+
+        int c = get_group_id(0);
+        int lid = get_local_id(0);
+        int is_min = method == TM_SQDIFF || method == TM_SQDIFF_NORMED;
+        int cx = cand[2 * c];
+        int cy = cand[2 * c + 1];
+        int side = 2 * radius + 1;
+        int rcols = src_cols - tpl_cols + 1;
+        int rrows = src_rows - tpl_rows + 1;
+        float area = (float)(tpl_cols * tpl_rows);
+
+        float best = 0.f;
+        int best_pos = -1;
+        for (int k = lid; k < side * side; k += WG) {
+            int x = cx + k % side - radius;
+            int y = cy + k / side - radius;
+            if (x < 0 || y < 0 || x >= rcols || y >= rrows)
+                continue;
+            float sIT = 0.f, sI = 0.f, sI2 = 0.f, sD2 = 0.f;
+            for (int j = 0; j < tpl_rows; ++j) {
+                __global const uchar* srow = src + src_offset + (y + j) * src_step + x;
+                __global const uchar* trow = tpl + tpl_offset + j * tpl_step;
+                for (int i = 0; i < tpl_cols; ++i) {
+                    float a = srow[i];
+                    float b = trow[i];
+                    float d = a - b;
+                    sIT += a * b;
+                    sI += a;
+                    sI2 += a * a;
+                    sD2 += d * d;
+                }
+            }
+            float s = matchScore(method, sIT, sI, sI2, sD2, sT2, meanT, normT, area);
+            int pos = y * rcols + x;
+            if (better(s, pos, best, best_pos, is_min)) {
+                best = s;
+                best_pos = pos;
+            }
+        }
+        lval[lid] = best;
+        lpos[lid] = best_pos;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int s = WG / 2; s > 0; s >>= 1) {
+            if (lid < s && better(lval[lid + s], lpos[lid + s], lval[lid], lpos[lid], is_min)) {
+                lval[lid] = lval[lid + s];
+                lpos[lid] = lpos[lid + s];
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (lid == 0) {
+            out_val[c] = lval[0];
+            out_pos[c] = lpos[0];
+        }
+    }
+)";
+
+class PyramidMatcher {
+public:
+    struct Candidate {
+        cv::Point loc;
+        float score;
+    };
+
+    // levels <= 0 picks as many levels as keep the template >= minTemplSide
+    PyramidMatcher(int levels = 0, int candidates = 8, int radius = 3, int minTemplSide = 8)
+        : levels_(levels), candidates_(candidates), radius_(radius), minTemplSide_(minTemplSide),
+          source_(std::string(matchScoreSource) + pyramidMatchSource) {
+        wg_ = (int)std::min<size_t>(64, cv::ocl::Device::getDefault().maxWorkGroupSize());
+        opts_ = cv::format("-D WG=%d", wg_);
+        // built once here only to report build errors early; refine() creates
+        // its kernel per launch (an async-run cv::ocl::Kernel can't be rerun)
+        if (cv::ocl::Kernel("refineCandidates", source_, opts_).empty()) {
+            throw std::runtime_error("Failed to build refineCandidates kernel");
+        }
+    }
+
+    void setSource(const cv::UMat& gray) {
+        CV_Assert(gray.type() == CV_8UC1);
+        src_ = gray;
+        srcPyr_.clear();
+        if (!tmplPyr_.empty())
+            buildSourcePyramid();
+    }
+
+    void setTemplate(const cv::UMat& tmpl) {
+        CV_Assert(tmpl.type() == CV_8UC1);
+        int levels = levels_;
+        if (levels <= 0) {
+            levels = 0;
+            int side = std::min(tmpl.cols, tmpl.rows);
+            while ((side >> (levels + 1)) >= minTemplSide_)
+                levels++;
+        }
+        tmplPyr_.assign(1, tmpl);
+        for (int l = 1; l <= levels; ++l) {
+            cv::UMat down;
+            cv::pyrDown(tmplPyr_.back(), down);
+            tmplPyr_.push_back(down);
+        }
+        stats_.clear();
+        for (auto& t : tmplPyr_)
+            stats_.push_back(templStats(t.getMat(cv::ACCESS_READ)));
+        srcPyr_.clear();
+        if (!src_.empty())
+            buildSourcePyramid();
+    }
+
+    int levels() const { return (int)tmplPyr_.size() - 1; }
+
+    // best location at full resolution; all kept candidates in `kept`
+    Candidate match(int method, std::vector<Candidate>* kept = nullptr) {
+        CV_Assert(!srcPyr_.empty() && srcPyr_.size() == tmplPyr_.size());
+        int top = levels();
+
+        // exhaustive search at the coarsest level only
+        cv::UMat result;
+        cv::matchTemplate(srcPyr_[top], tmplPyr_[top], result, method);
+        std::vector<Candidate> cands = topCandidates(result, method, tmplPyr_[top].size());
+
+        for (int l = top - 1; l >= 0; --l) {
+            for (auto& c : cands)
+                c.loc *= 2;
+            cands = refine(l, method, cands);
+        }
+
+        if (kept)
+            *kept = cands;
+        bool useMin = isSqdiff(method);
+        auto best = std::min_element(cands.begin(), cands.end(), [useMin](const Candidate& a, const Candidate& b) {
+            return useMin ? a.score < b.score : a.score > b.score;
+        });
+        return best != cands.end() ? *best : Candidate{cv::Point(-1, -1), 0.f};
+    }
+
+private:
+    void buildSourcePyramid() {
+        srcPyr_.assign(1, src_);
+        for (int l = 1; l < (int)tmplPyr_.size(); ++l) {
+            cv::UMat down;
+            cv::pyrDown(srcPyr_.back(), down);
+            srcPyr_.push_back(down);
+        }
+    }
+
+    // K best peaks of a (small) coarse result map, suppressing neighbours
+    std::vector<Candidate> topCandidates(const cv::UMat& uresult, int method, cv::Size tmpl) {
+        cv::Mat result = uresult.getMat(cv::ACCESS_READ).clone();
+        bool useMin = isSqdiff(method);
+        float worst = useMin ? FLT_MAX : -FLT_MAX;
+        std::vector<Candidate> out;
+        for (int k = 0; k < candidates_; ++k) {
+            double minVal, maxVal;
+            cv::Point minLoc, maxLoc;
+            cv::minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+            cv::Point p = matchPoint(method, minLoc, maxLoc);
+            float v = (float)(useMin ? minVal : maxVal);
+            if (v == worst)
+                break;
+            out.push_back(Candidate{p, v});
+            cv::Rect suppress(p.x - tmpl.width / 2, p.y - tmpl.height / 2, tmpl.width, tmpl.height);
+            result(suppress & cv::Rect(0, 0, result.cols, result.rows)).setTo(worst);
+        }
+        return out;
+    }
+
+    std::vector<Candidate> refine(int level, int method, const std::vector<Candidate>& cands) {
+        if (cands.empty())
+            return {};
+        int k = (int)cands.size();
+        cv::Mat pos(1, 2 * k, CV_32SC1);
+        for (int i = 0; i < k; ++i) {
+            pos.at<int>(0, 2 * i) = cands[i].loc.x;
+            pos.at<int>(0, 2 * i + 1) = cands[i].loc.y;
+        }
+        pos.copyTo(candBuf_);
+        outVal_.create(1, k, CV_32FC1);
+        outPos_.create(1, k, CV_32SC1);
+
+        const TemplStats& s = stats_[level];
+        cv::ocl::Kernel kernel("refineCandidates", source_, opts_);
+        kernel.args(cv::ocl::KernelArg::ReadOnly(srcPyr_[level]), cv::ocl::KernelArg::ReadOnly(tmplPyr_[level]),
+                    cv::ocl::KernelArg::PtrReadOnly(candBuf_), radius_, method, s.sumT2, s.meanT, s.normT,
+                    cv::ocl::KernelArg::PtrWriteOnly(outVal_), cv::ocl::KernelArg::PtrWriteOnly(outPos_));
+        size_t global[1] = {(size_t)k * wg_};
+        size_t local[1] = {(size_t)wg_};
+        if (!kernel.run(1, global, local, false)) {
+            throw std::runtime_error("refineCandidates launch failed");
+        }
+
+        cv::Mat vals, idxs;
+        outVal_.copyTo(vals);
+        outPos_.copyTo(idxs);
+        int rcols = srcPyr_[level].cols - tmplPyr_[level].cols + 1;
+        std::vector<Candidate> out;
+        for (int i = 0; i < k; ++i) {
+            int p = idxs.at<int>(0, i);
+            if (p >= 0)
+                out.push_back(Candidate{cv::Point(p % rcols, p / rcols), vals.at<float>(0, i)});
+        }
+        return out;
+    }
+
+    int levels_, candidates_, radius_, minTemplSide_;
+    int wg_ = 64;
+    std::string opts_;
+    cv::ocl::ProgramSource source_;
+    cv::UMat src_, candBuf_, outVal_, outPos_;
+    std::vector<cv::UMat> srcPyr_, tmplPyr_;
+    std::vector<TemplStats> stats_;
+};
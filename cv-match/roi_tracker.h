@@ -0,0 +1,95 @@
+#pragma once
+
+// Temporal ROI tracking for streaming template matching.
+//
+// The target moves little between frames, so after a confident hit only a
+// window of `margin` pixels around the last location is searched on the GPU.
+// When the confidence of the ROI hit drops below `minConfidence` (occlusion,
+// fast motion, scene cut) the same frame is searched in full again.
+// Only normalized methods are accepted so the score is a confidence.
+
+#include "cv_common.h"
+
+#include <vector>
+
+class RoiTracker {
+public:
+    struct Result {
+        cv::Point loc;
+        double confidence;
+        bool fullSearch;     // whole frame was scanned for this result
+        double seconds;      // matching latency, queue finished
+    };
+
+    RoiTracker(int margin = 32, double minConfidence = 0.8, int method = cv::TM_CCOEFF_NORMED)
+        : margin_(margin), minConfidence_(minConfidence), method_(method) {
+        CV_Assert(method == cv::TM_SQDIFF_NORMED || method == cv::TM_CCORR_NORMED || method == cv::TM_CCOEFF_NORMED);
+    }
+
+    void setTemplate(const cv::UMat& tmpl) {
+        tmpl_ = tmpl;
+        reset();
+    }
+
+    // forget the last location, next frame is a full search
+    void reset() {
+        haveLast_ = false;
+    }
+
+    Result track(const cv::UMat& frame) {
+        double t = (double)cv::getTickCount();
+        Result r;
+        r.fullSearch = !haveLast_;
+        if (haveLast_) {
+            cv::Rect roi(last_.x - margin_, last_.y - margin_, tmpl_.cols + 2 * margin_, tmpl_.rows + 2 * margin_);
+            roi &= cv::Rect(0, 0, frame.cols, frame.rows);
+            if (roi.width >= tmpl_.cols && roi.height >= tmpl_.rows) {
+                search(frame(roi), r);
+                r.loc += roi.tl();
+            } else {
+                r.confidence = 0.0;
+            }
+            if (r.confidence < minConfidence_)
+                r.fullSearch = true;
+        }
+        if (r.fullSearch)
+            search(frame, r);
+        cv::ocl::finish();
+        r.seconds = elapsedSeconds(t);
+
+        frames_++;
+        fullSearches_ += r.fullSearch ? 1 : 0;
+        latencies_.push_back(r.seconds);
+        haveLast_ = r.confidence >= minConfidence_;
+        last_ = r.loc;
+        return r;
+    }
+
+    size_t frames() const { return frames_; }
+    size_t fullSearches() const { return fullSearches_; }
+    // the very first frame always needs a full search, it is not a fallback
+    double fallbackRate() const {
+        return frames_ > 1 ? (double)(fullSearches_ - 1) / (frames_ - 1) : 0.0;
+    }
+    const std::vector<double>& latencies() const { return latencies_; }
+
+private:
+    void search(const cv::UMat& img, Result& r) {
+        cv::matchTemplate(img, tmpl_, result_, method_);
+        double minVal, maxVal;
+        cv::Point minLoc, maxLoc;
+        cv::minMaxLoc(result_, &minVal, &maxVal, &minLoc, &maxLoc);
+        r.loc = matchPoint(method_, minLoc, maxLoc);
+        r.confidence = isSqdiff(method_) ? 1.0 - minVal : maxVal;
+    }
+
+    int margin_;
+    double minConfidence_;
+    int method_;
+    cv::UMat tmpl_, result_;
+    bool haveLast_ = false;
+    cv::Point last_;
+    size_t frames_ = 0;
+    size_t fullSearches_ = 0;
+    std::vector<double> latencies_;
+};
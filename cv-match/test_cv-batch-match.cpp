@@ -0,0 +1,99 @@
+#include "cv_common.h"
+#include "batch_matcher.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// usage: ./app [src_img] [num_templates] [method]
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    int numTemplates = argc > 2 ? atoi(argv[2]) : 200;
+    int method = argc > 3 ? atoi(argv[3]) : TM_SQDIFF;
+
+    initOpenCL();
+    std::cout << "method: " << methodName(method) << ", templates: " << numTemplates << std::endl;
+
+    try {
+        Mat gray_src = loadGray(srcPath);
+
+        // templates cut from the source at random places, 16..64 px
+        std::mt19937 rng(427);
+        vector<Mat> templs;
+        vector<Point> truth;
+        for (int i = 0; i < numTemplates; ++i) {
+            int w = 16 + rng() % 49;
+            int h = 16 + rng() % 49;
+            int x = rng() % (gray_src.cols - w);
+            int y = rng() % (gray_src.rows - h);
+            templs.push_back(gray_src(Rect(x, y, w, h)).clone());
+            truth.push_back(Point(x, y));
+        }
+
+        UMat usrc;
+        gray_src.copyTo(usrc);
+
+        // batched: one upload of source + atlas, two launches per frame
+        BatchMatcher matcher(method);
+        matcher.setTemplates(templs);
+        matcher.setSource(usrc);
+        matcher.match();  // warm up: program build + first upload
+        cv::ocl::finish();
+
+        const int runs = 10;
+        double t = (double)getTickCount();
+        vector<MatchHit> hits;
+        for (int r = 0; r < runs; ++r) {
+            hits = matcher.match();
+        }
+        cv::ocl::finish();
+        t = ((double)getTickCount() - t) / getTickFrequency() / runs;
+        std::cout << "batched time per frame: " << t << " second, "
+                  << numTemplates / t << " templates/s" << std::endl;
+
+        // baseline: one cv::matchTemplate + cv::minMaxLoc per template
+        vector<UMat> utempls(templs.size());
+        for (size_t i = 0; i < templs.size(); ++i) {
+            templs[i].copyTo(utempls[i]);
+        }
+        UMat result;
+        matchTemplate(usrc, utempls[0], result, method);
+        cv::ocl::finish();
+
+        double tb = (double)getTickCount();
+        vector<Point> baseline(templs.size());
+        for (size_t i = 0; i < utempls.size(); ++i) {
+            double minVal, maxVal;
+            Point minLoc, maxLoc;
+            matchTemplate(usrc, utempls[i], result, method);
+            minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+            baseline[i] = matchPoint(method, minLoc, maxLoc);
+        }
+        cv::ocl::finish();
+        tb = ((double)getTickCount() - tb) / getTickFrequency();
+        std::cout << "per-template time per frame: " << tb << " second, "
+                  << numTemplates / tb << " templates/s" << std::endl;
+        std::cout << "speedup: " << tb / t << "x" << std::endl;
+
+        int mismatches = 0;
+        for (const auto& hit : hits) {
+            if (hit.loc != baseline[hit.templ]) {
+                if (mismatches < 10) {
+                    std::cout << "templ " << hit.templ << " batched (" << hit.loc.x << "," << hit.loc.y
+                              << ") matchTemplate (" << baseline[hit.templ].x << "," << baseline[hit.templ].y
+                              << ") cut at (" << truth[hit.templ].x << "," << truth[hit.templ].y << ")" << std::endl;
+                }
+                mismatches++;
+            }
+        }
+        std::cout << "mismatches: " << mismatches << " / " << hits.size() << std::endl;
+        return mismatches == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
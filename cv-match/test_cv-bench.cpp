@@ -0,0 +1,139 @@
+// CPU vs GPU cv::matchTemplate benchmark.
+//
+// runMatchGrayUseGpu in test_cv.cpp used to time the very first matchTemplate
+// call, i.e. OpenCL program build + lazy upload + an unfinished queue. Here:
+//   - first_ms   first GPU call of a config, queue finished (includes the
+//                program build the first time a method is seen)
+//   - median/p95 steady state over N runs, inputs already resident, every
+//                run ends with cv::ocl::finish() before the clock stops
+// Each config is matchTemplate + minMaxLoc, since the location is what we need.
+//
+// usage: ./app [src_img] [runs] [csv_file]
+
+#include "cv_common.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+struct BenchResult {
+    double first;
+    double median;
+    double p95;
+};
+
+static Point locate(InputArray result, int method) {
+    double minVal, maxVal;
+    Point minLoc, maxLoc;
+    minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+    return matchPoint(method, minLoc, maxLoc);
+}
+
+static BenchResult benchCpu(const Mat& src, const Mat& tmp, int method, int runs, Point& loc) {
+    Mat result;
+    BenchResult r;
+    double t = (double)getTickCount();
+    matchTemplate(src, tmp, result, method);
+    loc = locate(result, method);
+    r.first = elapsedSeconds(t);
+
+    vector<double> times;
+    for (int i = 0; i < runs; ++i) {
+        t = (double)getTickCount();
+        matchTemplate(src, tmp, result, method);
+        loc = locate(result, method);
+        times.push_back(elapsedSeconds(t));
+    }
+    r.median = percentile(times, 0.5);
+    r.p95 = percentile(times, 0.95);
+    return r;
+}
+
+static BenchResult benchGpu(const Mat& src, const Mat& tmp, int method, int runs, Point& loc) {
+    // upload outside the clock, this harness measures matching only
+    UMat usrc, utmp, result;
+    src.copyTo(usrc);
+    tmp.copyTo(utmp);
+    cv::ocl::finish();
+
+    BenchResult r;
+    double t = (double)getTickCount();
+    matchTemplate(usrc, utmp, result, method);
+    loc = locate(result, method);
+    cv::ocl::finish();
+    r.first = elapsedSeconds(t);
+
+    vector<double> times;
+    for (int i = 0; i < runs; ++i) {
+        t = (double)getTickCount();
+        matchTemplate(usrc, utmp, result, method);
+        loc = locate(result, method);
+        cv::ocl::finish();
+        times.push_back(elapsedSeconds(t));
+    }
+    r.median = percentile(times, 0.5);
+    r.p95 = percentile(times, 0.95);
+    return r;
+}
+
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    int runs = argc > 2 ? atoi(argv[2]) : 30;
+    string csvPath = argc > 3 ? argv[3] : "";
+
+    initOpenCL();
+
+    FILE* csv = csvPath.empty() ? stdout : fopen(csvPath.c_str(), "w");
+    if (!csv) {
+        std::cerr << "Failed to open " << csvPath << std::endl;
+        return 1;
+    }
+
+    try {
+        Mat base = loadGray(srcPath);
+
+        const Size imageSizes[] = {Size(640, 480), Size(1280, 720), Size(1920, 1080), Size(3840, 2160)};
+        const int templSizes[] = {16, 32, 64, 128};
+        const int methods[] = {TM_SQDIFF, TM_SQDIFF_NORMED, TM_CCORR, TM_CCORR_NORMED, TM_CCOEFF, TM_CCOEFF_NORMED};
+
+        fprintf(csv, "method,img_w,img_h,tpl,device,first_ms,median_ms,p95_ms,winner\n");
+        for (int method : methods) {
+            for (const Size& isz : imageSizes) {
+                Mat src;
+                resize(base, src, isz, 0, 0, INTER_LINEAR);
+                for (int ts : templSizes) {
+                    if (ts >= isz.width || ts >= isz.height)
+                        continue;
+                    // template cut off-center so the answer is unambiguous
+                    Rect roi(isz.width / 3, isz.height / 3, ts, ts);
+                    Mat tmp = src(roi).clone();
+
+                    Point cpuLoc, gpuLoc;
+                    BenchResult cpu = benchCpu(src, tmp, method, runs, cpuLoc);
+                    BenchResult gpu = benchGpu(src, tmp, method, runs, gpuLoc);
+                    const char* winner = gpu.median < cpu.median ? "gpu" : "cpu";
+
+                    fprintf(csv, "%s,%d,%d,%d,cpu,%.3f,%.3f,%.3f,%s\n", methodName(method), isz.width, isz.height, ts,
+                            cpu.first * 1e3, cpu.median * 1e3, cpu.p95 * 1e3, winner);
+                    fprintf(csv, "%s,%d,%d,%d,gpu,%.3f,%.3f,%.3f,%s\n", methodName(method), isz.width, isz.height, ts,
+                            gpu.first * 1e3, gpu.median * 1e3, gpu.p95 * 1e3, winner);
+                    fflush(csv);
+                    if (cpuLoc != gpuLoc) {
+                        std::cerr << methodName(method) << " " << isz << " tpl " << ts << ": cpu (" << cpuLoc.x << ","
+                                  << cpuLoc.y << ") gpu (" << gpuLoc.x << "," << gpuLoc.y << ")" << std::endl;
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    if (csv != stdout)
+        fclose(csv);
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "cv_common.h"
+#include "fft_matcher.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// same as runMatchGrayUseCpu, returns the location instead of printing it
+static Point matchGrayUseCpu(const Mat& gray_src, const Mat& gray_tmp, int method, double& t) {
+    Mat result;
+    t = (double)getTickCount();
+    matchTemplate(gray_src, gray_tmp, result, method);
+    t = elapsedSeconds(t);
+    double minVal, maxVal;
+    Point minLoc, maxLoc;
+    minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+    return matchPoint(method, minLoc, maxLoc);
+}
+
+static Point locate(const UMat& result, int method) {
+    double minVal, maxVal;
+    Point minLoc, maxLoc;
+    minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+    return matchPoint(method, minLoc, maxLoc);
+}
+
+// usage: ./app [src_img] [tmp_img] [max_fft_dim]
+//   a small max_fft_dim (e.g. 512) forces the overlap-save tiled path
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    string tmpPath = argc > 2 ? argv[2] : TMP_IMG;
+    int maxFftDim = argc > 3 ? atoi(argv[3]) : 4096;
+    const int runs = 10;
+
+    initOpenCL();
+
+    try {
+        Mat gray_src = loadGray(srcPath);
+        Mat gray_tmp = loadGray(tmpPath);
+        std::cout << "src: " << gray_src.size() << " tmp: " << gray_tmp.size() << std::endl;
+
+        UMat usrc, utmp;
+        gray_src.copyTo(usrc);
+        gray_tmp.copyTo(utmp);
+
+        int tileDim = std::min(2048, std::max(maxFftDim / 2, 2 * std::max(gray_tmp.cols, gray_tmp.rows)));
+        FftMatcher fft(maxFftDim, tileDim, std::max(gray_tmp.cols, gray_tmp.rows));
+        double ts = (double)getTickCount();
+        fft.setSource(usrc);
+        cv::ocl::finish();
+        ts = elapsedSeconds(ts);
+        std::cout << "fft size: " << fft.fftSize() << ", tiles: " << fft.tiles()
+                  << ", source spectrum: " << ts << " second" << std::endl;
+        std::cout << "cost direct: " << FftMatcher::costDirect(gray_src.size(), gray_tmp.size())
+                  << " cost fft: " << fft.costFft(gray_tmp.size())
+                  << " -> auto select: " << (fft.preferFft(gray_tmp.size()) ? "fft" : "direct") << std::endl;
+
+        FftMatcher::TemplateSpectrum spec = fft.prepare(utmp);
+
+        const int methods[] = {TM_SQDIFF, TM_SQDIFF_NORMED, TM_CCORR, TM_CCORR_NORMED, TM_CCOEFF, TM_CCOEFF_NORMED};
+        int failures = 0;
+        for (int method : methods) {
+            double tcpu = 0.0;
+            Point cpu = matchGrayUseCpu(gray_src, gray_tmp, method, tcpu);
+
+            // direct GPU, warm
+            UMat result;
+            matchTemplate(usrc, utmp, result, method);
+            cv::ocl::finish();
+            double tdirect = (double)getTickCount();
+            for (int r = 0; r < runs; ++r) {
+                matchTemplate(usrc, utmp, result, method);
+            }
+            cv::ocl::finish();
+            tdirect = elapsedSeconds(tdirect) / runs;
+            Point direct = locate(result, method);
+
+            // FFT, warm, cached source and template spectra
+            UMat fresult;
+            fft.match(spec, method, fresult);
+            cv::ocl::finish();
+            double tfft = (double)getTickCount();
+            for (int r = 0; r < runs; ++r) {
+                fft.match(spec, method, fresult);
+            }
+            cv::ocl::finish();
+            tfft = elapsedSeconds(tfft) / runs;
+            Point viaFft = locate(fresult, method);
+
+            bool ok = viaFft == cpu;
+            failures += ok ? 0 : 1;
+            printf("%-17s cpu %8.3f ms (%d,%d)  direct %8.3f ms (%d,%d)  fft %8.3f ms (%d,%d)  %s\n",
+                   methodName(method), tcpu * 1e3, cpu.x, cpu.y, tdirect * 1e3, direct.x, direct.y,
+                   tfft * 1e3, viaFft.x, viaFft.y, ok ? "ok" : "MISMATCH");
+        }
+        // matchAuto: the cost model's own pick, then each branch forced through
+        // the penalty (0: FFT whenever the plan fits, huge: always direct)
+        for (double penalty : {4.0, 0.0, 1e30}) {
+            bool expectFft = fft.preferFft(gray_tmp.size(), penalty);
+            for (int method : methods) {
+                double tcpu = 0.0;
+                Point cpu = matchGrayUseCpu(gray_src, gray_tmp, method, tcpu);
+                UMat aresult;
+                bool usedFft = fft.matchAuto(utmp, method, aresult, &spec, penalty);
+                Point viaAuto = locate(aresult, method);
+                bool ok = usedFft == expectFft && viaAuto == cpu;
+                failures += ok ? 0 : 1;
+                printf("auto penalty %-6g %-17s -> %-6s (%d,%d)  %s\n", penalty, methodName(method),
+                       usedFft ? "fft" : "direct", viaAuto.x, viaAuto.y, ok ? "ok" : "MISMATCH");
+            }
+        }
+        std::cout << "failures: " << failures << std::endl;
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,90 @@
+#include "cv_common.h"
+#include "fused_matcher.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// three passes on the GPU, as runMatchGrayUseGpu in test_cv.cpp
+static Point threePass(const UMat& usrc, const UMat& utmp, int method, UMat& gray, UMat& result) {
+    cvtColor(usrc, gray, COLOR_RGB2GRAY);
+    matchTemplate(gray, utmp, result, method);
+    double minVal, maxVal;
+    Point minLoc, maxLoc;
+    minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+    return matchPoint(method, minLoc, maxLoc);
+}
+
+// usage: ./app [src_img] [tmp_img] [scale] [runs]
+//   scale 4 turns moon.jpg into a 4K-class frame
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    string tmpPath = argc > 2 ? argv[2] : TMP_IMG;
+    double scale = argc > 3 ? atof(argv[3]) : 1.0;
+    int runs = argc > 4 ? atoi(argv[4]) : 20;
+
+    initOpenCL();
+
+    try {
+        Mat src = imread(srcPath, IMREAD_COLOR);
+        if (src.empty()) {
+            throw std::runtime_error("Failed to read image " + srcPath);
+        }
+        Mat gray_tmp = loadGray(tmpPath);
+        if (scale != 1.0) {
+            resize(src, src, Size(), scale, scale, INTER_LINEAR);
+            resize(gray_tmp, gray_tmp, Size(), scale, scale, INTER_LINEAR);
+        }
+        std::cout << "src: " << src.size() << " tmp: " << gray_tmp.size() << std::endl;
+
+        UMat usrc, utmp, gray, result;
+        src.copyTo(usrc);
+        gray_tmp.copyTo(utmp);
+
+        int failures = 0;
+        for (int method : {TM_SQDIFF, TM_CCORR}) {
+            FusedMatcher fm(method);
+            fm.setTemplate(gray_tmp);
+
+            // warm up both paths so kernel builds are not timed
+            Point ref = threePass(usrc, utmp, method, gray, result);
+            MatchHit hit = fm.match(usrc);
+            cv::ocl::finish();
+
+            vector<double> t3, tf;
+            for (int r = 0; r < runs; ++r) {
+                double t = (double)getTickCount();
+                ref = threePass(usrc, utmp, method, gray, result);
+                cv::ocl::finish();
+                t3.push_back(elapsedSeconds(t));
+
+                t = (double)getTickCount();
+                hit = fm.match(usrc);
+                tf.push_back(elapsedSeconds(t));
+            }
+
+            // intermediate bytes written by the three-pass path vs the fused one
+            double bytes3 = (double)src.total() + (double)result.total() * sizeof(float);
+            // fused: one (min, max) float + int pair per tile
+            int tile = fm.tile();
+            int groups = ((result.cols + tile - 1) / tile) * ((result.rows + tile - 1) / tile);
+            double bytesF = (double)groups * 16;
+
+            double m3 = percentile(t3, 0.5), mf = percentile(tf, 0.5);
+            std::cout << methodName(method) << ": three-pass median " << m3 * 1e3 << " ms, fused median " << mf * 1e3
+                      << " ms, speedup " << m3 / mf << "x" << std::endl;
+            std::cout << "  intermediate writes: three-pass " << bytes3 / 1e6 << " MB, fused ~" << bytesF / 1e3 << " KB"
+                      << ", halo cache " << fm.localBytes() << " bytes" << std::endl;
+            std::cout << "  obj.x :" << hit.loc.x << " obj.y :" << hit.loc.y
+                      << (hit.loc == ref ? " (matches three-pass)" : " (DIFFERS from three-pass)") << std::endl;
+            failures += hit.loc == ref ? 0 : 1;
+        }
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,96 @@
+#include "cv_common.h"
+#include "integral_cache.h"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// usage: ./app [src_img] [num_templates] [method] [frames]
+//   any method works, the window sums only matter for 0, 1, 3, 4 and 5
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    int numTemplates = argc > 2 ? atoi(argv[2]) : 50;
+    int method = argc > 3 ? atoi(argv[3]) : TM_CCOEFF_NORMED;
+    int numFrames = argc > 4 ? atoi(argv[4]) : 4;
+
+    initOpenCL();
+    std::cout << "method: " << methodName(method) << ", templates: " << numTemplates << ", frames: " << numFrames << std::endl;
+
+    try {
+        Mat gray_src = loadGray(srcPath);
+
+        std::mt19937 rng(1031);
+        vector<Mat> templs;
+        vector<TemplStats> stats;
+        for (int i = 0; i < numTemplates; ++i) {
+            int w = 24 + rng() % 41;
+            int h = 24 + rng() % 41;
+            int x = rng() % (gray_src.cols - w);
+            int y = rng() % (gray_src.rows - h);
+            templs.push_back(gray_src(Rect(x, y, w, h)).clone());
+            stats.push_back(templStats(templs.back()));
+        }
+        vector<UMat> utmps(templs.size());
+        for (size_t i = 0; i < templs.size(); ++i)
+            templs[i].copyTo(utmps[i]);
+
+        // frames: the source, slightly brightened each time, streamed into one UMat
+        UMat usrc, result;
+        gray_src.copyTo(usrc);
+
+        NormalizedMatcher nm;
+        matchTemplate(usrc, utmps[0], result, method);   // warm up both paths
+        nm.match(usrc, utmps[0], stats[0], method, result);
+        nm.cache().invalidate();
+        cv::ocl::finish();
+
+        double tRef = 0.0, tCached = 0.0;
+        int disagree = 0;
+        for (int f = 0; f < numFrames; ++f) {
+            Mat frame;
+            gray_src.convertTo(frame, -1, 1.0, 3.0 * f);
+            frame.copyTo(usrc);
+            nm.cache().invalidate();   // same buffer, new content
+            cv::ocl::finish();
+
+            vector<Point> ref(templs.size()), got(templs.size());
+            double minVal, maxVal;
+            Point minLoc, maxLoc;
+
+            double t = (double)getTickCount();
+            for (size_t i = 0; i < templs.size(); ++i) {
+                matchTemplate(usrc, utmps[i], result, method);
+                minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+                ref[i] = matchPoint(method, minLoc, maxLoc);
+            }
+            cv::ocl::finish();
+            tRef += elapsedSeconds(t);
+
+            t = (double)getTickCount();
+            for (size_t i = 0; i < templs.size(); ++i) {
+                nm.match(usrc, utmps[i], stats[i], method, result);
+                minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+                got[i] = matchPoint(method, minLoc, maxLoc);
+            }
+            cv::ocl::finish();
+            tCached += elapsedSeconds(t);
+
+            for (size_t i = 0; i < templs.size(); ++i)
+                disagree += ref[i] == got[i] ? 0 : 1;
+        }
+
+        double n = (double)numFrames * templs.size();
+        std::cout << "matchTemplate per template: " << tRef / n * 1e3 << " ms" << std::endl;
+        std::cout << "cached integral per template: " << tCached / n * 1e3 << " ms, speedup " << tRef / tCached << "x" << std::endl;
+        std::cout << "integral builds: " << nm.cache().builds() - 1 << " for " << numFrames << " frames" << std::endl;
+        std::cout << "locations differing from matchTemplate: " << disagree << std::endl;
+        return disagree == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,118 @@
+#include "cv_common.h"
+#include "match_pipeline.h"
+
+#include <opencv2/core/utils/filesystem.hpp>
+
+#include <iostream>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// usage: ./app <image_dir|video> [tmp_img] [decoders] [queue_depth]
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <image_dir|video> [tmp_img] [decoders] [queue_depth]" << std::endl;
+        return 1;
+    }
+    string input = argv[1];
+    string tmpPath = argc > 2 ? argv[2] : TMP_IMG;
+    int decoders = argc > 3 ? atoi(argv[3]) : 2;
+    int depth = argc > 4 ? atoi(argv[4]) : 2;
+    int method = TM_SQDIFF;
+
+    initOpenCL();
+
+    try {
+        Mat gray_tmp = loadGray(tmpPath);
+
+        // glob() throws on anything but a directory
+        vector<String> found, files;
+        bool isVideo = !utils::fs::isDirectory(input);
+        if (!isVideo) {
+            const char* patterns[] = {"/*.jpg", "/*.jpeg", "/*.png", "/*.bmp"};
+            for (const char* p : patterns) {
+                glob(input + p, found, false);
+                files.insert(files.end(), found.begin(), found.end());
+            }
+            if (files.empty()) {
+                throw std::runtime_error("No images in " + input);
+            }
+        }
+        vector<string> sources(files.begin(), files.end());
+        if (isVideo)
+            sources.push_back(input);
+        std::cout << (isVideo ? "video: " : "images: ") << (isVideo ? input : std::to_string(sources.size())) << std::endl;
+
+        // warm up the kernels on one frame
+        {
+            Mat first = isVideo ? Mat() : imread(sources[0], IMREAD_COLOR);
+            if (isVideo) {
+                VideoCapture cap(input);
+                cap.read(first);
+            }
+            if (first.empty()) {
+                throw std::runtime_error("Failed to read first frame");
+            }
+            UMat gray, utmp, result;
+            toGray(first.getUMat(ACCESS_READ), gray);
+            gray_tmp.copyTo(utmp);
+            matchTemplate(gray, utmp, result, method);
+            cv::ocl::finish();
+        }
+
+        // 1. synchronous, test_cv.cpp style: decode, upload, match one by one
+        size_t syncFrames = 0;
+        double t = (double)getTickCount();
+        {
+            UMat utmp, gray, result;
+            gray_tmp.copyTo(utmp);
+            VideoCapture cap;
+            if (isVideo)
+                cap.open(input);
+            for (size_t i = 0;; ++i) {
+                Mat img;
+                if (isVideo) {
+                    if (!cap.read(img))
+                        break;
+                } else {
+                    if (i >= sources.size())
+                        break;
+                    img = imread(sources[i], IMREAD_COLOR);
+                }
+                UMat src = img.getUMat(ACCESS_READ);
+                toGray(src, gray);
+                matchTemplate(gray, utmp, result, method);
+                double minVal, maxVal;
+                Point minLoc, maxLoc;
+                minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+                cv::ocl::finish();
+                syncFrames++;
+            }
+        }
+        double tsync = elapsedSeconds(t);
+        printf("sync:     %zu frames, %.3f s, %.2f frames/s\n", syncFrames, tsync, syncFrames / tsync);
+
+        // 2. pipelined
+        MatchPipeline pipeline(sources, isVideo, gray_tmp, method, decoders, depth);
+        vector<PipelineFrame> results = pipeline.run();
+        double wall = pipeline.wallSeconds();
+        printf("pipeline: %zu frames, %.3f s, %.2f frames/s (%d decoders, depth %d)\n",
+               results.size(), wall, results.size() / wall, decoders, depth);
+        printf("utilization decode %.1f%%  upload %.1f%%  match %.1f%%\n",
+               pipeline.decodeStats().utilization(wall) * 100.0,
+               pipeline.uploadStats().utilization(wall) * 100.0,
+               pipeline.matchStats().utilization(wall) * 100.0);
+
+        for (size_t i = 0; i < results.size() && i < 5; ++i) {
+            std::cout << "frame " << results[i].index << " " << results[i].name
+                      << " obj.x :" << results[i].loc.x << " obj.y :" << results[i].loc.y << std::endl;
+        }
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "cv_common.h"
+#include "pyramid_matcher.h"
+
+#include <iostream>
+
+using namespace cv;
+using namespace std;
+
+// usage: ./app [src_img] [tmp_img] [scale] [candidates] [method]
+//   scale 4 turns moon.jpg into a 4K-class frame
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    string tmpPath = argc > 2 ? argv[2] : TMP_IMG;
+    double scale = argc > 3 ? atof(argv[3]) : 1.0;
+    int candidates = argc > 4 ? atoi(argv[4]) : 8;
+    int method = argc > 5 ? atoi(argv[5]) : TM_SQDIFF;
+    const int runs = 10;
+
+    initOpenCL();
+    std::cout << "method: " << methodName(method) << std::endl;
+
+    try {
+        Mat gray_src = loadGray(srcPath);
+        Mat gray_tmp = loadGray(tmpPath);
+        if (scale != 1.0) {
+            resize(gray_src, gray_src, Size(), scale, scale, INTER_LINEAR);
+            resize(gray_tmp, gray_tmp, Size(), scale, scale, INTER_LINEAR);
+        }
+        std::cout << "src: " << gray_src.size() << " tmp: " << gray_tmp.size() << std::endl;
+
+        // reference, runMatchGrayUseCpu
+        Mat cpuResult;
+        double t = (double)getTickCount();
+        matchTemplate(gray_src, gray_tmp, cpuResult, method);
+        t = elapsedSeconds(t);
+        double minVal, maxVal;
+        Point minLoc, maxLoc;
+        minMaxLoc(cpuResult, &minVal, &maxVal, &minLoc, &maxLoc);
+        Point cpu = matchPoint(method, minLoc, maxLoc);
+        std::cout << "CPU full search: " << t << " second, obj.x :" << cpu.x << " obj.y :" << cpu.y << std::endl;
+
+        UMat usrc, utmp;
+        gray_src.copyTo(usrc);
+        gray_tmp.copyTo(utmp);
+
+        // full-resolution GPU search, warm
+        UMat result;
+        matchTemplate(usrc, utmp, result, method);
+        cv::ocl::finish();
+        t = (double)getTickCount();
+        for (int r = 0; r < runs; ++r) {
+            matchTemplate(usrc, utmp, result, method);
+            minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+        }
+        cv::ocl::finish();
+        double tfull = elapsedSeconds(t) / runs;
+        std::cout << "GPU full search: " << tfull << " second" << std::endl;
+
+        // pyramids are built once per source / template
+        PyramidMatcher pm(0, candidates);
+        t = (double)getTickCount();
+        pm.setTemplate(utmp);
+        pm.setSource(usrc);
+        cv::ocl::finish();
+        std::cout << "pyramid levels: " << pm.levels() << ", build: " << elapsedSeconds(t) << " second" << std::endl;
+
+        vector<PyramidMatcher::Candidate> kept;
+        PyramidMatcher::Candidate best = pm.match(method, &kept);  // warm up
+        cv::ocl::finish();
+        t = (double)getTickCount();
+        for (int r = 0; r < runs; ++r) {
+            best = pm.match(method, &kept);
+        }
+        cv::ocl::finish();
+        double tpyr = elapsedSeconds(t) / runs;
+        std::cout << "GPU pyramid search: " << tpyr << " second, speedup " << tfull / tpyr << "x" << std::endl;
+        for (const auto& c : kept) {
+            std::cout << "  candidate (" << c.loc.x << "," << c.loc.y << ") score " << c.score << std::endl;
+        }
+        std::cout << "obj.x :" << best.loc.x << " obj.y :" << best.loc.y
+                  << (best.loc == cpu ? " (matches CPU)" : " (DIFFERS from CPU)") << std::endl;
+        return best.loc == cpu ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,95 @@
+#include "cv_common.h"
+#include "roi_tracker.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+// Synthetic stream: a camera window pans slowly over an up-scaled moon.jpg,
+// so the template (a fixed patch of the scene) drifts a few pixels per frame.
+// Every `cut_every` frames the camera jumps to force a full-search fallback.
+// A video file can be passed instead: its first frame's center patch is tracked.
+//
+// usage: ./app [src_img|video] [frames] [cut_every]
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    int numFrames = argc > 2 ? atoi(argv[2]) : 300;
+    int cutEvery = argc > 3 ? atoi(argv[3]) : 100;
+    const Size frameSize(1920, 1080);
+    const Size tmplSize(96, 96);
+
+    initOpenCL();
+
+    try {
+        vector<Mat> frames;
+        Mat scene = imread(srcPath, IMREAD_GRAYSCALE);
+        if (!scene.empty()) {
+            double s = std::max(2.0 * frameSize.width / scene.cols, 2.0 * frameSize.height / scene.rows);
+            resize(scene, scene, Size(), std::max(s, 1.0), std::max(s, 1.0), INTER_LINEAR);
+            int rangeX = scene.cols - frameSize.width;
+            int rangeY = scene.rows - frameSize.height;
+            for (int i = 0; i < numFrames; ++i) {
+                double phase = (cutEvery > 0 && (i / cutEvery) % 2 == 1) ? 0.5 : 0.0;
+                int x = (int)(rangeX * (0.25 + 0.1 * std::sin(0.02 * i) + phase * 0.5));
+                int y = (int)(rangeY * (0.25 + 0.1 * std::cos(0.015 * i) + phase * 0.5));
+                frames.push_back(scene(Rect(x, y, frameSize.width, frameSize.height)));
+            }
+        } else {
+            VideoCapture cap(srcPath);
+            Mat frame, gray;
+            while ((int)frames.size() < numFrames && cap.read(frame)) {
+                toGray(frame, gray);
+                frames.push_back(gray.clone());
+            }
+        }
+        if (frames.empty()) {
+            throw std::runtime_error("No frames from " + srcPath);
+        }
+
+        Mat first = frames[0];
+        Rect tmplRect((first.cols - tmplSize.width) / 2, (first.rows - tmplSize.height) / 2, tmplSize.width, tmplSize.height);
+        UMat utmp;
+        first(tmplRect).copyTo(utmp);
+
+        // warm up so compile time is not counted
+        UMat uframe;
+        first.copyTo(uframe);
+        RoiTracker warmup;
+        warmup.setTemplate(utmp);
+        warmup.track(uframe);
+        warmup.track(uframe);
+
+        RoiTracker tracker;
+        tracker.setTemplate(utmp);
+        RoiTracker fullOnly(0, 2.0);   // confidence can never reach 2: always full search
+        fullOnly.setTemplate(utmp);
+
+        vector<double> fullLatency;
+        int disagree = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            frames[i].copyTo(uframe);
+            RoiTracker::Result r = tracker.track(uframe);
+            RoiTracker::Result f = fullOnly.track(uframe);
+            fullLatency.push_back(f.seconds);
+            if (r.loc != f.loc && f.confidence >= 0.8)
+                disagree++;
+        }
+
+        const vector<double>& lat = tracker.latencies();
+        printf("frames: %zu\n", tracker.frames());
+        printf("roi tracking  latency median %.3f ms p95 %.3f ms\n", percentile(lat, 0.5) * 1e3, percentile(lat, 0.95) * 1e3);
+        printf("full search   latency median %.3f ms p95 %.3f ms\n",
+               percentile(fullLatency, 0.5) * 1e3, percentile(fullLatency, 0.95) * 1e3);
+        printf("full-search fallbacks: %zu (rate %.2f%%)\n", tracker.fullSearches() - 1, tracker.fallbackRate() * 100.0);
+        printf("frames where roi and full search disagree: %d\n", disagree);
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
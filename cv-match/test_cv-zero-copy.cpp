@@ -0,0 +1,118 @@
+#include "cv_common.h"
+#include "zero_copy_umat.h"
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+static vector<uchar> readFileBytes(const string& path) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open " + path);
+    }
+    return vector<uchar>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+struct StageTimes {
+    vector<double> decode;   // decode (+ copy into an OpenCL buffer for the baseline)
+    vector<double> match;    // cvtColor + matchTemplate + minMaxLoc, queue finished
+};
+
+static Point matchOnGpu(const UMat& src, const UMat& gray_tmp, int method) {
+    UMat gray_src, result;
+    toGray(src, gray_src);
+    matchTemplate(gray_src, gray_tmp, result, method);
+    double minVal, maxVal;
+    Point minLoc, maxLoc;
+    minMaxLoc(result, &minVal, &maxVal, &minLoc, &maxLoc);
+    cv::ocl::finish();
+    return matchPoint(method, minLoc, maxLoc);
+}
+
+static void report(const char* name, const StageTimes& st) {
+    double d = percentile(st.decode, 0.5) * 1e3;
+    double m = percentile(st.match, 0.5) * 1e3;
+    printf("%-10s decode+upload: %8.3f ms  match: %8.3f ms  total: %8.3f ms\n", name, d, m, d + m);
+}
+
+// usage: ./app [src_img] [tmp_img] [runs]
+int main(int argc, char** argv) {
+    string srcPath = argc > 1 ? argv[1] : SRC_IMG;
+    string tmpPath = argc > 2 ? argv[2] : TMP_IMG;
+    int runs = argc > 3 ? atoi(argv[3]) : 20;
+    int method = TM_SQDIFF;
+
+    initOpenCL();
+
+    try {
+        // compressed frame as it would arrive from disk or network
+        vector<uchar> encoded = readFileBytes(srcPath);
+        Mat probe = imdecode(encoded, IMREAD_COLOR);
+        if (probe.empty()) {
+            throw std::runtime_error("Failed to decode " + srcPath);
+        }
+        std::cout << "frame: " << probe.cols << "x" << probe.rows << std::endl;
+
+        UMat gray_tmp;
+        loadGray(tmpPath).copyTo(gray_tmp);
+
+        // warm up kernels so neither path pays for compilation
+        Point expected = matchOnGpu(probe.getUMat(ACCESS_READ), gray_tmp, method);
+
+        // 1. baseline, the test_cv.cpp way: decode into a Mat, getUMat copies it
+        StageTimes base;
+        for (int r = 0; r < runs; ++r) {
+            double t0 = (double)getTickCount();
+            Mat img = imdecode(encoded, IMREAD_COLOR);
+            UMat src;
+            img.copyTo(src);
+            cv::ocl::finish();
+            double t1 = (double)getTickCount();
+            Point p = matchOnGpu(src, gray_tmp, method);
+            double t2 = (double)getTickCount();
+            base.decode.push_back((t1 - t0) / getTickFrequency());
+            base.match.push_back((t2 - t1) / getTickFrequency());
+            CV_Assert(p == expected);
+        }
+        report("copy", base);
+
+        // 2./3. decode into memory already wrapped by a UMat
+        FrameMemory kinds[] = {FrameMemory::Aligned, FrameMemory::Svm};
+        const char* names[] = {"aligned", "svm"};
+        for (int k = 0; k < 2; ++k) {
+            if (kinds[k] == FrameMemory::Svm && !cv::ocl::haveSVM()) {
+                std::cout << "skip svm: not supported" << std::endl;
+                continue;
+            }
+            ZeroCopyFrame frame(kinds[k], probe.size(), probe.type());
+            StageTimes st;
+            for (int r = 0; r < runs; ++r) {
+                double t0 = (double)getTickCount();
+                if (!frame.decode(encoded)) {
+                    throw std::runtime_error("in-place decode failed");
+                }
+                UMat src = frame.umat();
+                double t1 = (double)getTickCount();
+                Point p = matchOnGpu(src, gray_tmp, method);
+                double t2 = (double)getTickCount();
+                st.decode.push_back((t1 - t0) / getTickFrequency());
+                st.match.push_back((t2 - t1) / getTickFrequency());
+                CV_Assert(p == expected);
+            }
+            report(names[k], st);
+            std::cout << names[k] << " fallback copies: " << frame.copies() << std::endl;
+        }
+
+        std::cout << "obj.x :" << expected.x << " obj.y :" << expected.y << std::endl;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
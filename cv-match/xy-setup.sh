@@ -0,0 +1,41 @@
+sudo apt install opencl-header ocl-icd-opencl-dev
+
+# opencv built with WITH_OPENCL=ON, installed to /usr/local
+# moon.jpg / moon-2.jpg are the same images as test_cv.cpp, copy them here
+
+# batched multi-template matching, templates/s vs one matchTemplate per template
+source build.sh test_cv-batch-match.cpp
+./app moon.jpg 200 0 2>&1 | tee mylog
+
+# zero-copy UMat over aligned host memory / SVM vs imread().getUMat()
+source build.sh test_cv-zero-copy.cpp
+./app moon.jpg moon-2.jpg 20 2>&1 | tee mylog
+
+# CPU vs GPU matchTemplate: first call vs steady state median/p95, all TM_* methods
+source build.sh test_cv-bench.cpp
+./app moon.jpg 30 bench.csv
+
+# FFT (mixed-radix Stockham) matchTemplate vs direct, checked against the CPU location
+source build.sh test_cv-fft-match.cpp
+./app moon.jpg moon-2.jpg
+./app moon.jpg moon-2.jpg 512   # force overlap-save tiling
+
+# coarse-to-fine pyramid search, 4K-class frame via scale 4
+source build.sh test_cv-pyramid.cpp
+./app moon.jpg moon-2.jpg 4 8 0 2>&1 | tee mylog
+
+# temporal ROI tracking vs full-frame search, per-frame latency + fallback rate
+source build.sh test_cv-roi-track.cpp
+./app moon.jpg 300 100 2>&1 | tee mylog
+
+# decode -> pinned upload -> match pipeline over a local image directory (or a video)
+source build.sh test_cv-pipeline.cpp
+./app ./frames moon-2.jpg 2 2 2>&1 | tee mylog
+
+# fused BGR->gray + match + min/max location vs cvtColor/matchTemplate/minMaxLoc
+source build.sh test_cv-fused-match.cpp
+./app moon.jpg moon-2.jpg 4 20 2>&1 | tee mylog
+
+# cached integral images for the normalized methods, many templates x frames
+source build.sh test_cv-integral.cpp
+./app moon.jpg 50 5 4 2>&1 | tee mylog
@@ -0,0 +1,159 @@
+#pragma once
+
+// Zero-copy cv::UMat over host memory we own.
+//
+// cv::imread(...).getUMat() decodes into a malloc'd Mat and then copies it into
+// a fresh OpenCL buffer. ZeroCopyFrame instead owns page-aligned host memory
+// (or an SVM allocation in OpenCV's context), wraps it once in a
+// CL_MEM_USE_HOST_PTR buffer and exposes it through cv::ocl::convertFromBuffer.
+// Images are decoded straight into that memory while it is mapped, so on
+// devices with unified memory (Intel iGPU) no byte is copied after decode.
+
+#include "cv_common.h"
+
+#include <CL/cl.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+enum class FrameMemory {
+    Aligned,    // aligned_alloc, 4 KB pages
+    Svm,        // clSVMAlloc in the OpenCV context
+};
+
+class ZeroCopyFrame {
+public:
+    static const size_t kPage = 4096;
+
+    ZeroCopyFrame(FrameMemory kind, cv::Size size, int type) : kind_(kind), size_(size), type_(type) {
+        step_ = (size_t)size.width * CV_ELEM_SIZE(type);
+        // zero-copy on Intel needs a 4 KB aligned pointer and 64 B multiple size
+        bytes_ = (step_ * size.height + kPage - 1) / kPage * kPage;
+        context_ = (cl_context)cv::ocl::Context::getDefault().ptr();
+        queue_ = (cl_command_queue)cv::ocl::Queue::getDefault().ptr();
+
+        if (kind_ == FrameMemory::Aligned) {
+            host_ = aligned_alloc(kPage, bytes_);
+        } else {
+            cl_device_id device = (cl_device_id)cv::ocl::Device::getDefault().ptr();
+            cl_device_svm_capabilities caps = 0;
+            clGetDeviceInfo(device, CL_DEVICE_SVM_CAPABILITIES, sizeof(caps), &caps, nullptr);
+            fineGrain_ = (caps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) != 0;
+            cl_svm_mem_flags flags = CL_MEM_READ_WRITE | (fineGrain_ ? CL_MEM_SVM_FINE_GRAIN_BUFFER : 0);
+            host_ = clSVMAlloc(context_, flags, bytes_, kPage);
+        }
+        if (!host_) {
+            throw std::runtime_error("ZeroCopyFrame allocation failed");
+        }
+
+        // an SVM pointer passed as host_ptr makes the buffer use the SVM storage
+        cl_int err = CL_SUCCESS;
+        buffer_ = clCreateBuffer(context_, CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, bytes_, host_, &err);
+        if (err != CL_SUCCESS) {
+            release();
+            throw std::runtime_error("clCreateBuffer(CL_MEM_USE_HOST_PTR) failed: " + std::to_string(err));
+        }
+    }
+
+    ~ZeroCopyFrame() {
+        umat_.release();
+        release();
+    }
+
+    ZeroCopyFrame(const ZeroCopyFrame&) = delete;
+    ZeroCopyFrame& operator=(const ZeroCopyFrame&) = delete;
+
+    cv::Size size() const { return size_; }
+    int type() const { return type_; }
+    void* data() const { return host_; }
+
+    // decode an encoded image (jpg/png bytes) straight into our memory.
+    // Returns false when the image does not have the frame's size/type.
+    bool decode(const std::vector<uchar>& encoded, int flags = cv::IMREAD_COLOR) {
+        umat_.release();
+        void* ptr = map(CL_MAP_WRITE_INVALIDATE_REGION);
+        cv::Mat dst(size_, type_, ptr, step_);
+        cv::Mat out = cv::imdecode(encoded, flags, &dst);
+        bool inPlace = out.data == ptr;
+        bool ok = !out.empty() && out.size() == size_ && out.type() == type_;
+        // decoder had to reallocate (unexpected): keep the result correct anyway
+        if (ok && !inPlace) {
+            out.copyTo(cv::Mat(size_, type_, ptr, step_));
+            copies_++;
+        }
+        unmap(ptr);
+        return ok;
+    }
+
+    // host access outside decode(), e.g. to fill the frame from a camera
+    cv::Mat mapMat(cl_map_flags flags = CL_MAP_READ | CL_MAP_WRITE) {
+        umat_.release();
+        mapped_ = map(flags);
+        return cv::Mat(size_, type_, mapped_, step_);
+    }
+
+    void unmapMat() {
+        if (mapped_) {
+            unmap(mapped_);
+            mapped_ = nullptr;
+        }
+    }
+
+    // UMat sharing our cl_mem, no allocation and no copy
+    cv::UMat umat() {
+        if (umat_.empty()) {
+            cv::ocl::convertFromBuffer(buffer_, step_, size_.height, size_.width, type_, umat_);
+        }
+        return umat_;
+    }
+
+    // number of decodes that could not land in place
+    size_t copies() const { return copies_; }
+
+private:
+    void* map(cl_map_flags flags) {
+        if (kind_ == FrameMemory::Svm && fineGrain_)
+            return host_;
+        cl_int err = CL_SUCCESS;
+        void* ptr = clEnqueueMapBuffer(queue_, buffer_, CL_TRUE, flags, 0, bytes_, 0, nullptr, nullptr, &err);
+        if (err != CL_SUCCESS || !ptr) {
+            throw std::runtime_error("clEnqueueMapBuffer failed: " + std::to_string(err));
+        }
+        return ptr;
+    }
+
+    void unmap(void* ptr) {
+        if (kind_ == FrameMemory::Svm && fineGrain_)
+            return;
+        clEnqueueUnmapMemObject(queue_, buffer_, ptr, 0, nullptr, nullptr);
+        clFinish(queue_);
+    }
+
+    void release() {
+        if (buffer_) {
+            clReleaseMemObject(buffer_);
+            buffer_ = nullptr;
+        }
+        if (host_) {
+            if (kind_ == FrameMemory::Aligned) free(host_);
+            else clSVMFree(context_, host_);
+            host_ = nullptr;
+        }
+    }
+
+    FrameMemory kind_;
+    cv::Size size_;
+    int type_;
+    size_t step_ = 0;
+    size_t bytes_ = 0;
+    bool fineGrain_ = false;
+    size_t copies_ = 0;
+    void* host_ = nullptr;
+    void* mapped_ = nullptr;
+    cl_context context_ = nullptr;
+    cl_command_queue queue_ = nullptr;
+    cl_mem buffer_ = nullptr;
+    cv::UMat umat_;
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+// One large cl::Buffer per context, carved into sub-buffers
+// (clCreateSubBuffer) instead of one cl::Buffer per array.
+//
+//   Bump   offsets only grow; reset() at the end of a frame frees everything
+//   Buddy  power-of-two blocks with split / merge, so slices can be released
+//          one by one; reset() also works
+//
+// Offsets are multiples of CL_DEVICE_MEM_BASE_ADDR_ALIGN (reported in bits),
+// otherwise clCreateSubBuffer fails with CL_MISALIGNED_SUB_BUFFER_OFFSET.
+//
+// A sub-buffer is still a driver object. The arena keeps the ones it has
+// created, keyed by (offset, size). A steady-state frame that makes the same
+// allocations as the previous one gets the cached objects back and creates
+// nothing. Stats::subBuffersCreated shows how many were really made.
+//
+// Sub-buffers inherit the parent's host-pointer flags (ALLOC_HOST_PTR,
+// USE_HOST_PTR, COPY_HOST_PTR); clCreateSubBuffer rejects them, so only the
+// access flags are passed on.
+
+#include "../primitives/ocl_env.h"
+
+#include <map>
+#include <set>
+
+struct ArenaSlice {
+    cl::Buffer buffer;   // sub-buffer
+    size_t offset = 0;
+    size_t bytes = 0;
+};
+
+class BufferArena {
+public:
+    enum class Mode { Bump, Buddy };
+
+    struct Stats {
+        size_t allocations = 0;
+        size_t subBuffersCreated = 0;
+        size_t cacheHits = 0;
+        size_t resets = 0;
+        size_t highWater = 0;
+    };
+
+    // Buddy rounds `bytes` up to a power-of-two number of alignment units
+    BufferArena(OclEnv& env, size_t bytes, Mode mode, cl_mem_flags flags = CL_MEM_READ_WRITE, size_t maxCached = 4096)
+        : mode_(mode),
+          subFlags_(flags & ~(cl_mem_flags)(CL_MEM_USE_HOST_PTR | CL_MEM_ALLOC_HOST_PTR | CL_MEM_COPY_HOST_PTR)),
+          maxCached_(maxCached) {
+        align_ = std::max<size_t>(env.device.getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8, 4);
+        if (mode == Mode::Buddy) {
+            minBlock_ = std::max<size_t>(align_, 256);
+            size_t size = minBlock_;
+            maxOrder_ = 0;
+            while (size < bytes) {
+                size <<= 1;
+                maxOrder_++;
+            }
+            bytes = size;
+            free_.resize(maxOrder_ + 1);
+            free_[maxOrder_].insert(0);
+        }
+        bytes_ = bytes;
+        cl_int err = CL_SUCCESS;
+        buffer_ = cl::Buffer(env.context, flags, bytes, nullptr, &err);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("BufferArena: buffer of " + std::to_string(bytes) + " bytes failed: " + std::to_string(err));
+    }
+
+    Mode mode() const { return mode_; }
+    size_t bytes() const { return bytes_; }
+    size_t alignment() const { return align_; }
+    const cl::Buffer& buffer() const { return buffer_; }
+    const Stats& stats() const { return stats_; }
+    size_t used() const { return used_; }
+
+    ArenaSlice allocate(size_t bytes) {
+        if (bytes == 0)
+            throw std::runtime_error("BufferArena: zero-byte allocation");
+        size_t offset = mode_ == Mode::Bump ? bumpAlloc(bytes) : buddyAlloc(bytes);
+        stats_.allocations++;
+        stats_.highWater = std::max(stats_.highWater, used_);
+        return ArenaSlice{subBuffer(offset, bytes), offset, bytes};
+    }
+
+    // Buddy only; Bump slices go away with reset()
+    void release(const ArenaSlice& slice) {
+        if (mode_ != Mode::Buddy)
+            return;
+        auto it = live_.find(slice.offset);
+        if (it == live_.end())
+            throw std::runtime_error("BufferArena: release of an unknown slice");
+        size_t offset = it->first;
+        int order = it->second;
+        live_.erase(it);
+        used_ -= blockBytes(order);
+        // merge with free buddies
+        for (; order < maxOrder_; ++order) {
+            size_t buddy = offset ^ blockBytes(order);
+            auto b = free_[order].find(buddy);
+            if (b == free_[order].end())
+                break;
+            free_[order].erase(b);
+            offset = std::min(offset, buddy);
+        }
+        free_[order].insert(offset);
+    }
+
+    // end of frame: every slice is free again (cached sub-buffers are kept)
+    void reset() {
+        used_ = 0;
+        top_ = 0;
+        if (mode_ == Mode::Buddy) {
+            live_.clear();
+            for (auto& f : free_)
+                f.clear();
+            free_[maxOrder_].insert(0);
+        }
+        stats_.resets++;
+    }
+
+private:
+    size_t bumpAlloc(size_t bytes) {
+        size_t offset = (top_ + align_ - 1) / align_ * align_;
+        if (offset + bytes > bytes_)
+            throw std::runtime_error("BufferArena: out of space (" + std::to_string(bytes) + " bytes requested, " +
+                                     std::to_string(bytes_ - std::min(offset, bytes_)) + " left)");
+        top_ = offset + bytes;
+        used_ = top_;
+        return offset;
+    }
+
+    size_t blockBytes(int order) const { return minBlock_ << order; }
+
+    size_t buddyAlloc(size_t bytes) {
+        int order = 0;
+        while (blockBytes(order) < bytes && order <= maxOrder_)
+            order++;
+        int j = order;
+        while (j <= maxOrder_ && free_[j].empty())
+            j++;
+        if (order > maxOrder_ || j > maxOrder_)
+            throw std::runtime_error("BufferArena: no free block for " + std::to_string(bytes) + " bytes");
+        size_t offset = *free_[j].begin();
+        free_[j].erase(free_[j].begin());
+        // split down, the upper halves stay free
+        for (; j > order; --j)
+            free_[j - 1].insert(offset + blockBytes(j - 1));
+        live_[offset] = order;
+        used_ += blockBytes(order);
+        return offset;
+    }
+
+    cl::Buffer subBuffer(size_t offset, size_t bytes) {
+        auto key = std::make_pair(offset, bytes);
+        auto it = cache_.find(key);
+        if (it != cache_.end()) {
+            stats_.cacheHits++;
+            return it->second;
+        }
+        cl_buffer_region region = {offset, bytes};
+        cl_int err = CL_SUCCESS;
+        cl::Buffer sub = buffer_.createSubBuffer(subFlags_, CL_BUFFER_CREATE_TYPE_REGION, &region, &err);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("clCreateSubBuffer failed: " + std::to_string(err));
+        stats_.subBuffersCreated++;
+        if (cache_.size() >= maxCached_)
+            cache_.clear();
+        cache_.emplace(key, sub);
+        return sub;
+    }
+
+    Mode mode_;
+    cl_mem_flags subFlags_;   // parent flags without the host-pointer ones
+    size_t maxCached_;
+    size_t align_ = 0;
+    size_t bytes_ = 0;
+    cl::Buffer buffer_;
+    Stats stats_;
+    size_t used_ = 0;
+
+    // bump
+    size_t top_ = 0;
+    // buddy: free offsets per order, live offset -> order
+    size_t minBlock_ = 0;
+    int maxOrder_ = 0;
+    std::vector<std::set<size_t>> free_;
+    std::map<size_t, int> live_;
+
+    std::map<std::pair<size_t, size_t>, cl::Buffer> cache_;
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+// Host <-> device transfers through a ring of pinned staging chunks.
+//
+// enqueueWriteBuffer from pageable memory (a std::vector) makes the driver
+// bounce the data through its own pinned staging, usually synchronously and
+// one copy at a time. StagingRing keeps `chunks` CL_MEM_ALLOC_HOST_PTR
+// buffers of `chunkBytes` each, mapped once for its whole lifetime, and
+// splits large transfers across them:
+//
+//   write  memcpy chunk k into a free pinned slot, enqueue the DMA from it,
+//          go on with chunk k+1 while chunk k is on the bus
+//   read   keep up to `chunks` DMAs into pinned slots in flight, memcpy each
+//          one out as it lands and refill its slot
+//
+// The pinned pointers are handed to enqueueWriteBuffer / enqueueReadBuffer as
+// host pointers; drivers recognise them and DMA directly. A slot is reused
+// only after the event of its last transfer has completed. With
+// copyThreads > 1 each chunk's memcpy is split across that many threads,
+// which helps when a single core cannot keep up with the bus.
+//
+//     StagingRing ring(env, 8 << 20, 4);
+//     ring.write(buf, 0, host.data(), bytes);   // host reusable on return
+//     ... kernels on env.queue ...
+//     ring.read(host.data(), buf, 0, bytes);    // blocks until host is filled
+//
+// Transfers smaller than directBelow() go straight through the queue.
+
+#include "../primitives/ocl_env.h"
+
+#include <thread>
+
+class StagingRing {
+public:
+    struct Stats {
+        size_t chunks = 0;        // staged chunk transfers
+        size_t stagedBytes = 0;
+        size_t directBytes = 0;
+        size_t slotWaits = 0;     // slot still busy with an earlier DMA
+    };
+
+    StagingRing(OclEnv& env, size_t chunkBytes = 8 << 20, int chunks = 4, int copyThreads = 1)
+        : queue_(env.queue), chunkBytes_(chunkBytes), copyThreads_(std::max(copyThreads, 1)),
+          directBelow_(chunkBytes) {
+        if (chunkBytes == 0 || chunks < 1)
+            throw std::runtime_error("StagingRing: empty ring");
+        for (int i = 0; i < chunks; ++i) {
+            cl_int err = CL_SUCCESS;
+            Slot slot;
+            slot.buffer = cl::Buffer(env.context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, chunkBytes, nullptr, &err);
+            if (err != CL_SUCCESS)
+                throw std::runtime_error("StagingRing: pinned buffer of " + std::to_string(chunkBytes) +
+                                         " bytes failed: " + std::to_string(err));
+            slot.host = (char*)queue_.enqueueMapBuffer(slot.buffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, chunkBytes,
+                                                       nullptr, nullptr, &err);
+            if (!slot.host || err != CL_SUCCESS)
+                throw std::runtime_error("StagingRing: map of staging buffer failed: " + std::to_string(err));
+            slots_.push_back(slot);
+        }
+    }
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+
+    ~StagingRing() {
+        for (Slot& slot : slots_) {
+            if (slot.busy())
+                slot.busy.wait();
+            queue_.enqueueUnmapMemObject(slot.buffer, slot.host);
+        }
+        queue_.finish();
+    }
+
+    size_t chunkBytes() const { return chunkBytes_; }
+    int chunks() const { return (int)slots_.size(); }
+    const Stats& stats() const { return stats_; }
+    size_t directBelow() const { return directBelow_; }
+    void setDirectBelow(size_t bytes) { directBelow_ = bytes; }
+
+    // src may be reused on return; the returned event is the last chunk's DMA,
+    // later commands on the same in-order queue see all of dst
+    cl::Event write(const cl::Buffer& dst, size_t dstOffset, const void* src, size_t bytes) {
+        cl::Event last;
+        if (bytes < directBelow_) {
+            check(queue_.enqueueWriteBuffer(dst, CL_TRUE, dstOffset, bytes, src, nullptr, &last), "enqueueWriteBuffer");
+            stats_.directBytes += bytes;
+            return last;
+        }
+        const char* in = (const char*)src;
+        for (size_t done = 0, k = 0; done < bytes; done += chunkBytes_, ++k) {
+            size_t len = std::min(chunkBytes_, bytes - done);
+            Slot& slot = acquire(k);
+            hostCopy(slot.host, in + done, len);
+            check(queue_.enqueueWriteBuffer(dst, CL_FALSE, dstOffset + done, len, slot.host, nullptr, &slot.busy),
+                  "enqueueWriteBuffer");
+            // start the DMA now, not when the queue fills up
+            queue_.flush();
+            last = slot.busy;
+            stats_.chunks++;
+        }
+        stats_.stagedBytes += bytes;
+        return last;
+    }
+
+    // blocks until dst holds the data; commands enqueued before on the same
+    // in-order queue are complete by then
+    void read(void* dst, const cl::Buffer& src, size_t srcOffset, size_t bytes) {
+        if (bytes < directBelow_) {
+            check(queue_.enqueueReadBuffer(src, CL_TRUE, srcOffset, bytes, dst), "enqueueReadBuffer");
+            stats_.directBytes += bytes;
+            return;
+        }
+        char* out = (char*)dst;
+        size_t n = (bytes + chunkBytes_ - 1) / chunkBytes_;
+        auto enqueue = [&](size_t k) {
+            Slot& slot = acquire(k);
+            size_t offset = k * chunkBytes_;
+            size_t len = std::min(chunkBytes_, bytes - offset);
+            check(queue_.enqueueReadBuffer(src, CL_FALSE, srcOffset + offset, len, slot.host, nullptr, &slot.busy),
+                  "enqueueReadBuffer");
+            stats_.chunks++;
+        };
+        // fill the ring, then drain one slot and refill it
+        for (size_t k = 0; k < std::min(n, slots_.size()); ++k)
+            enqueue(k);
+        queue_.flush();
+        for (size_t k = 0; k < n; ++k) {
+            Slot& slot = slots_[k % slots_.size()];
+            slot.busy.wait();
+            slot.busy = cl::Event();
+            size_t offset = k * chunkBytes_;
+            hostCopy(out + offset, slot.host, std::min(chunkBytes_, bytes - offset));
+            if (k + slots_.size() < n) {
+                enqueue(k + slots_.size());
+                queue_.flush();
+            }
+        }
+        stats_.stagedBytes += bytes;
+    }
+
+    // waits for every staged DMA still in flight
+    void drain() {
+        for (Slot& slot : slots_)
+            if (slot.busy()) {
+                slot.busy.wait();
+                slot.busy = cl::Event();
+            }
+    }
+
+private:
+    struct Slot {
+        cl::Buffer buffer;
+        char* host = nullptr;
+        cl::Event busy;   // last transfer using host
+    };
+
+    static void check(cl_int err, const char* what) {
+        if (err != CL_SUCCESS)
+            throw std::runtime_error(std::string("StagingRing: ") + what + " failed: " + std::to_string(err));
+    }
+
+    // slot for chunk k, idle
+    Slot& acquire(size_t k) {
+        Slot& slot = slots_[k % slots_.size()];
+        if (slot.busy()) {
+            if (slot.busy.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() > CL_COMPLETE) {
+                stats_.slotWaits++;
+                slot.busy.wait();
+            }
+            slot.busy = cl::Event();
+        }
+        return slot;
+    }
+
+    void hostCopy(char* dst, const char* src, size_t len) const {
+        // below ~1 MB per thread the thread start costs more than it saves
+        int threads = (int)std::min<size_t>(copyThreads_, std::max<size_t>(len >> 20, 1));
+        if (threads == 1) {
+            memcpy(dst, src, len);
+            return;
+        }
+        size_t part = (len / threads + 63) / 64 * 64;
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t) {
+            size_t begin = std::min(len, t * part);
+            size_t end = std::min(len, begin + part);
+            if (begin < end)
+                workers.emplace_back([=] { memcpy(dst + begin, src + begin, end - begin); });
+        }
+        memcpy(dst, src, std::min(len, part));
+        for (std::thread& w : workers)
+            w.join();
+    }
+
+    cl::CommandQueue queue_;
+    size_t chunkBytes_;
+    int copyThreads_;
+    size_t directBelow_;
+    std::vector<Slot> slots_;
+    Stats stats_;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+// Frame-scoped SVM temporaries. SvmFrameArena reserves one SVM region up
+// front and hands out aligned slices by bumping a pointer; nothing is freed
+// individually, the whole arena is reset at once.
+//
+// SvmFrameRing rotates over several arenas so frame N+1 can allocate while
+// frame N's kernels still run:
+//
+//     SvmFrameRing ring(env, 64 << 20, 3);
+//     for (;;) {
+//         SvmFrameArena& arena = ring.begin();   // waits only if this arena's
+//         float* tmp = arena.allocate<float>(n); // last frame is still running
+//         ... enqueue work using tmp, last command -> ev ...
+//         ring.end(ev);                          // arena reusable once ev completes
+//     }
+//
+// Slices are aligned to CL_DEVICE_MEM_BASE_ADDR_ALIGN and at least 64 bytes.
+// Kernels take them with clSetKernelArgSVMPointer: a pointer into the middle
+// of an SVM allocation is a valid SVM argument.
+
+#include "../svm-structs/svm_common.h"
+
+#include <memory>
+
+class SvmFrameArena {
+public:
+    SvmFrameArena(OclEnv& env, size_t bytes, cl_svm_mem_flags flags = CL_MEM_READ_WRITE)
+        : mem_(env, bytes, flags) {
+        align_ = std::max<size_t>(env.device.getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8, 64);
+    }
+
+    void* allocate(size_t bytes) {
+        size_t offset = (top_ + align_ - 1) / align_ * align_;
+        if (offset + bytes > mem_.bytes())
+            throw std::runtime_error("SvmFrameArena: out of space (" + std::to_string(bytes) + " bytes requested, " +
+                                     std::to_string(mem_.bytes() - std::min(offset, mem_.bytes())) + " left)");
+        top_ = offset + bytes;
+        highWater_ = std::max(highWater_, top_);
+        return mem_.as<char>() + offset;
+    }
+    template <typename T> T* allocate(size_t n) { return static_cast<T*>(allocate(n * sizeof(T))); }
+
+    // every slice handed out so far becomes invalid
+    void reset() { top_ = 0; }
+
+    size_t used() const { return top_; }
+    size_t capacity() const { return mem_.bytes(); }
+    size_t highWater() const { return highWater_; }
+    size_t alignment() const { return align_; }
+
+private:
+    SvmAlloc mem_;
+    size_t align_ = 64;
+    size_t top_ = 0;
+    size_t highWater_ = 0;
+};
+
+class SvmFrameRing {
+public:
+    SvmFrameRing(OclEnv& env, size_t bytesPerArena, int arenas = 2, cl_svm_mem_flags flags = CL_MEM_READ_WRITE)
+        : fences_(std::max(arenas, 1)) {
+        for (int i = 0; i < std::max(arenas, 1); ++i)
+            arenas_.emplace_back(new SvmFrameArena(env, bytesPerArena, flags));
+    }
+    SvmFrameRing(const SvmFrameRing&) = delete;
+    SvmFrameRing& operator=(const SvmFrameRing&) = delete;
+
+    ~SvmFrameRing() {
+        for (cl::Event& fence : fences_)
+            if (fence())
+                fence.wait();
+    }
+
+    int size() const { return (int)arenas_.size(); }
+    // arena of the frame between begin() and end()
+    int current() const { return current_; }
+    size_t frames() const { return frames_; }
+    // begin() calls that had to wait for the GPU
+    size_t stalls() const { return stalls_; }
+
+    // next arena, reset; blocks until the last frame that used it has finished
+    SvmFrameArena& begin() {
+        if (inFrame_)
+            throw std::runtime_error("SvmFrameRing: begin() without end()");
+        current_ = (current_ + 1) % size();
+        cl::Event& fence = fences_[current_];
+        if (fence()) {
+            if (fence.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() > CL_COMPLETE) {
+                stalls_++;
+                fence.wait();
+            }
+            fence = cl::Event();
+        }
+        arenas_[current_]->reset();
+        inFrame_ = true;
+        return *arenas_[current_];
+    }
+
+    // `last` is the frame's final command; on an in-order queue it covers
+    // everything enqueued before it
+    void end(const cl::Event& last) {
+        if (!inFrame_)
+            throw std::runtime_error("SvmFrameRing: end() without begin()");
+        fences_[current_] = last;
+        inFrame_ = false;
+        frames_++;
+    }
+
+    // waits for every frame in flight
+    void drain() {
+        for (cl::Event& fence : fences_)
+            if (fence()) {
+                fence.wait();
+                fence = cl::Event();
+            }
+    }
+
+private:
+    std::vector<std::unique_ptr<SvmFrameArena>> arenas_;
+    std::vector<cl::Event> fences_;
+    int current_ = -1;
+    bool inFrame_ = false;
+    size_t frames_ = 0;
+    size_t stalls_ = 0;
+};
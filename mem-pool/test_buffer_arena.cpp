@@ -0,0 +1,135 @@
+// Per-frame arrays from one arena vs one cl::Buffer per array, the
+// bufferA/B/C style of the tests (ts_create_buf in test-ocl-use-host-ts.cpp).
+// Each frame allocates `arrays` arrays, runs vectorAdd on the first three and
+// checks one element; the arena is reset when the frame is done. A buddy
+// arena then takes random allocate / release churn.
+//
+// usage: ./app [frames] [arrays] [elems]
+
+#include "../primitives/ocl_env.h"
+#include "buffer_arena.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+static const char* vectorAddSource = R"(
+__kernel void vectorAdd(__global const float* a, __global const float* b, __global float* c, uint n)
+{
+    uint i = get_global_id(0);
+    if (i < n)
+        c[i] = a[i] + b[i];
+}
+)";
+
+static double elapsedUs(std::chrono::high_resolution_clock::time_point t0) {
+    return std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 1000;
+    int arrays = std::max(3, argc > 2 ? atoi(argv[2]) : 6);
+    uint32_t elems = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 1u << 18;
+
+    try {
+        OclEnv env = OclEnv::create();
+        cl::Program program = buildProgram(env, vectorAddSource);
+        cl::Kernel kernel(program, "vectorAdd");
+        cl::NDRange global((elems + 255) / 256 * 256);
+
+        // array k holds elems * (1 + k % 3) floats
+        std::vector<size_t> sizes;
+        size_t frameBytes = 0;
+        for (int k = 0; k < arrays; ++k) {
+            sizes.push_back((size_t)elems * (1 + k % 3) * sizeof(float));
+            frameBytes += sizes.back();
+        }
+        std::vector<float> ha(elems, 1.f), hb(elems, 2.f);
+        int failures = 0;
+
+        // runs one frame on a, b, c and checks c[n-1]
+        auto frame = [&](const cl::Buffer& a, const cl::Buffer& b, const cl::Buffer& c) {
+            env.queue.enqueueWriteBuffer(a, CL_FALSE, 0, elems * sizeof(float), ha.data());
+            env.queue.enqueueWriteBuffer(b, CL_FALSE, 0, elems * sizeof(float), hb.data());
+            kernel.setArg(0, a);
+            kernel.setArg(1, b);
+            kernel.setArg(2, c);
+            kernel.setArg(3, (cl_uint)elems);
+            env.queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, cl::NullRange);
+            float last = 0.f;
+            env.queue.enqueueReadBuffer(c, CL_TRUE, (elems - 1) * sizeof(float), sizeof(float), &last);
+            return last == 3.f;
+        };
+
+        // one cl::Buffer per array
+        std::vector<double> tCreate;
+        int errors = 0;
+        for (int f = 0; f < frames; ++f) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            std::vector<cl::Buffer> bufs;
+            for (size_t s : sizes)
+                bufs.emplace_back(env.context, CL_MEM_READ_WRITE, s);
+            tCreate.push_back(elapsedUs(t0));
+            errors += frame(bufs[0], bufs[1], bufs[2]) ? 0 : 1;
+        }
+        failures += errors;
+        printf("%-14s alloc/frame %9.2f us   driver objects %8zu   %s\n", "cl::Buffer", medianOf(tCreate),
+               (size_t)frames * arrays, errors == 0 ? "ok" : "MISMATCH");
+
+        // bump arena, reset per frame
+        BufferArena bump(env, frameBytes + arrays * 4096, BufferArena::Mode::Bump);
+        std::vector<double> tBump;
+        errors = 0;
+        for (int f = 0; f < frames; ++f) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            std::vector<ArenaSlice> slices;
+            for (size_t s : sizes)
+                slices.push_back(bump.allocate(s));
+            tBump.push_back(elapsedUs(t0));
+            errors += frame(slices[0].buffer, slices[1].buffer, slices[2].buffer) ? 0 : 1;
+            bump.reset();
+        }
+        failures += errors;
+        printf("%-14s alloc/frame %9.2f us   driver objects %8zu   %s  (align %zu B, %zu cache hits)\n", "arena bump",
+               medianOf(tBump), bump.stats().subBuffersCreated + 1, errors == 0 ? "ok" : "MISMATCH", bump.alignment(),
+               bump.stats().cacheHits);
+
+        // buddy arena under churn: slices never overlap, released space merges back
+        BufferArena buddy(env, frameBytes * 8, BufferArena::Mode::Buddy);
+        std::mt19937 rng(9);
+        std::vector<ArenaSlice> live;
+        errors = 0;
+        int ops = frames * arrays;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < ops; ++i) {
+            if (!live.empty() && (live.size() >= (size_t)arrays * 2 || rng() % 2)) {
+                size_t victim = rng() % live.size();
+                buddy.release(live[victim]);
+                live[victim] = live.back();
+                live.pop_back();
+            } else {
+                live.push_back(buddy.allocate(sizes[rng() % sizes.size()]));
+            }
+        }
+        double tBuddy = elapsedUs(t0) / ops;
+        for (size_t i = 0; i < live.size(); ++i)
+            for (size_t j = i + 1; j < live.size(); ++j)
+                if (live[i].offset < live[j].offset + live[j].bytes && live[j].offset < live[i].offset + live[i].bytes)
+                    errors++;
+        while (live.size() < 3)
+            live.push_back(buddy.allocate(sizes[0]));
+        errors += frame(live[0].buffer, live[1].buffer, live[2].buffer) ? 0 : 1;
+        for (const ArenaSlice& s : live)
+            buddy.release(s);
+        errors += buddy.used() == 0 ? 0 : 1;
+        failures += errors;
+        printf("%-14s alloc+free  %9.2f us   driver objects %8zu   %s  (%zu ops, high water %.1f MB of %.1f MB)\n",
+               "arena buddy", tBuddy, buddy.stats().subBuffersCreated + 1, errors == 0 ? "ok" : "MISMATCH",
+               (size_t)ops, buddy.stats().highWater / 1e6, buddy.bytes() / 1e6);
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
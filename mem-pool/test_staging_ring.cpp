@@ -0,0 +1,110 @@
+// Host <-> device bandwidth: enqueueWriteBuffer / enqueueReadBuffer straight
+// from a std::vector (host_buf.data() in the tests) against the same transfer
+// through StagingRing, for 1 MB up to maxMB, in steps of x4.
+//
+// The direct path is switched off, so sizes below one chunk also go through
+// the ring, as a single staged chunk without copy/DMA overlap. Each size is
+// timed `reps` times (fewer for the large ones) and the median reported. The
+// staged write is checked with a pageable read and the staged read against a
+// pageable write of a different pattern.
+//
+// usage: ./app [maxMB] [chunkMB] [chunks] [copyThreads]
+
+#include "../primitives/ocl_env.h"
+#include "staging_ring.h"
+
+#include <chrono>
+#include <cstdlib>
+
+static double elapsedSec(std::chrono::high_resolution_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+static void fill(std::vector<uint32_t>& v, uint32_t seed) {
+    for (size_t i = 0; i < v.size(); ++i)
+        v[i] = (uint32_t)i * 2654435761u + seed;
+}
+
+static bool same(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+    return memcmp(a.data(), b.data(), a.size() * sizeof(uint32_t)) == 0;
+}
+
+int main(int argc, char** argv) {
+    size_t maxMB = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1024;
+    size_t chunkMB = argc > 2 ? strtoul(argv[2], nullptr, 10) : 8;
+    int chunks = argc > 3 ? atoi(argv[3]) : 4;
+    int copyThreads = argc > 4 ? atoi(argv[4]) : 2;
+
+    try {
+        OclEnv env = OclEnv::create();
+        size_t maxAlloc = env.device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+        StagingRing ring(env, chunkMB << 20, chunks, copyThreads);
+        // every size through the ring, also those below one chunk
+        ring.setDirectBelow(0);
+        printf("staging: %d x %zu MB pinned, %d copy thread(s)\n\n", ring.chunks(), chunkMB, copyThreads);
+        printf("%8s  %12s %12s  %12s %12s  %s\n", "size", "write page", "write stage", "read page", "read stage",
+               "(GB/s)");
+        int failures = 0;
+
+        for (size_t mb = 1; mb <= maxMB; mb *= 4) {
+            size_t bytes = mb << 20;
+            if (bytes > maxAlloc) {
+                printf("%6zuMB  skipped, CL_DEVICE_MAX_MEM_ALLOC_SIZE is %zu MB\n", mb, maxAlloc >> 20);
+                break;
+            }
+            cl_int err = CL_SUCCESS;
+            cl::Buffer buffer(env.context, CL_MEM_READ_WRITE, bytes, nullptr, &err);
+            if (err != CL_SUCCESS)
+                throw std::runtime_error("buffer of " + std::to_string(mb) + " MB failed: " + std::to_string(err));
+            // pages touched before timing
+            std::vector<uint32_t> src(bytes / 4), dst(bytes / 4);
+            fill(src, 1);
+            fill(dst, 0);
+            int reps = (int)std::max<size_t>(3, std::min<size_t>(20, 512 / mb));
+
+            std::vector<double> tWritePage, tWriteStage, tReadPage, tReadStage;
+            for (int r = 0; r < reps; ++r) {
+                auto t0 = std::chrono::high_resolution_clock::now();
+                env.queue.enqueueWriteBuffer(buffer, CL_TRUE, 0, bytes, src.data());
+                tWritePage.push_back(elapsedSec(t0));
+
+                t0 = std::chrono::high_resolution_clock::now();
+                ring.write(buffer, 0, src.data(), bytes).wait();
+                tWriteStage.push_back(elapsedSec(t0));
+
+                t0 = std::chrono::high_resolution_clock::now();
+                env.queue.enqueueReadBuffer(buffer, CL_TRUE, 0, bytes, dst.data());
+                tReadPage.push_back(elapsedSec(t0));
+
+                t0 = std::chrono::high_resolution_clock::now();
+                ring.read(dst.data(), buffer, 0, bytes);
+                tReadStage.push_back(elapsedSec(t0));
+            }
+
+            // staged write -> pageable read
+            fill(src, (uint32_t)mb * 3 + 7);
+            ring.write(buffer, 0, src.data(), bytes);
+            env.queue.enqueueReadBuffer(buffer, CL_TRUE, 0, bytes, dst.data());
+            bool ok = same(src, dst);
+            // pageable write -> staged read
+            fill(src, (uint32_t)mb * 5 + 11);
+            env.queue.enqueueWriteBuffer(buffer, CL_TRUE, 0, bytes, src.data());
+            ring.read(dst.data(), buffer, 0, bytes);
+            ok = ok && same(src, dst);
+            failures += ok ? 0 : 1;
+
+            double gb = bytes / 1e9;
+            printf("%6zuMB  %12.2f %12.2f  %12.2f %12.2f  %s\n", mb, gb / medianOf(tWritePage),
+                   gb / medianOf(tWriteStage), gb / medianOf(tReadPage), gb / medianOf(tReadStage),
+                   ok ? "ok" : "MISMATCH");
+        }
+
+        const StagingRing::Stats& s = ring.stats();
+        printf("\nstaged chunks %zu (%.1f GB), slot waits %zu\n", s.chunks, s.stagedBytes / 1e9, s.slotWaits);
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
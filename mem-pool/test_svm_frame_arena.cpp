@@ -0,0 +1,150 @@
+// Frame temporaries: clSVMAlloc / clSVMFree per frame (test_ocl_svm.cpp
+// style) against SvmFrameRing with 1, 2 and 3 rotating arenas.
+//
+// A frame prepares its input on the host (a little CPU work), copies it into
+// an SVM temporary, runs tmp = in * 2 and out = tmp + 1 through two more
+// temporaries and copies `out` back. With one arena every frame waits for the
+// previous one; with two or more the host prepares frame N+1 while the GPU
+// runs frame N. Each result is checked when its arena comes round again.
+//
+// usage: ./app [frames] [elems]
+
+#include "../svm-structs/svm_common.h"
+#include "svm_frame_arena.h"
+
+#include <cstdlib>
+
+static const char* frameSource = R"(
+__kernel void twice(__global const float* in, __global float* out, uint n)
+{
+    uint i = get_global_id(0);
+    if (i < n)
+        out[i] = in[i] * 2.f;
+}
+
+__kernel void plusOne(__global const float* in, __global float* out, uint n)
+{
+    uint i = get_global_id(0);
+    if (i < n)
+        out[i] = in[i] + 1.f;
+}
+)";
+
+struct FrameKernels {
+    cl::Kernel twice, plusOne;
+    cl::NDRange global;
+    uint32_t n;
+
+    // in -> tmp -> out on the queue
+    void enqueue(OclEnv& env, float* in, float* tmp, float* out) {
+        setSvmArg(twice, 0, in);
+        setSvmArg(twice, 1, tmp);
+        twice.setArg(2, (cl_uint)n);
+        env.queue.enqueueNDRangeKernel(twice, cl::NullRange, global, cl::NullRange);
+        setSvmArg(plusOne, 0, tmp);
+        setSvmArg(plusOne, 1, out);
+        plusOne.setArg(2, (cl_uint)n);
+        env.queue.enqueueNDRangeKernel(plusOne, cl::NullRange, global, cl::NullRange);
+    }
+};
+
+static void prepare(std::vector<float>& input, int frame) {
+    for (size_t i = 0; i < input.size(); ++i)
+        input[i] = (float)((i * 7 + frame) % 1000);
+}
+
+static bool checkFrame(const std::vector<float>& output, int frame) {
+    for (size_t i = 0; i < output.size(); i += 101)
+        if (output[i] != (float)((i * 7 + frame) % 1000) * 2.f + 1.f)
+            return false;
+    return true;
+}
+
+static cl::Event svmCopyAsync(OclEnv& env, void* dst, const void* src, size_t bytes) {
+    cl_event ev = nullptr;
+    cl_int err = clEnqueueSVMMemcpy(env.queue(), CL_FALSE, dst, src, bytes, 0, nullptr, &ev);
+    if (err != CL_SUCCESS)
+        throw std::runtime_error("clEnqueueSVMMemcpy failed: " + std::to_string(err));
+    return cl::Event(ev);
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    uint32_t elems = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 1u << 20;
+
+    try {
+        OclEnv env = OclEnv::create();
+        if (!env.svm()) {
+            std::cout << "Device does not support SVM." << std::endl;
+            return 1;
+        }
+        cl::Program program = buildProgram(env, frameSource, "-cl-std=CL2.0");
+        FrameKernels k{cl::Kernel(program, "twice"), cl::Kernel(program, "plusOne"),
+                       cl::NDRange((elems + 255) / 256 * 256), elems};
+        size_t bytes = elems * sizeof(float);
+        int failures = 0;
+
+        // alloc / free per frame
+        {
+            std::vector<float> input(elems), output(elems);
+            int errors = 0;
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (int f = 0; f < frames; ++f) {
+                prepare(input, f);
+                float* in = (float*)clSVMAlloc(env.context(), CL_MEM_READ_WRITE, bytes, 0);
+                float* tmp = (float*)clSVMAlloc(env.context(), CL_MEM_READ_WRITE, bytes, 0);
+                float* out = (float*)clSVMAlloc(env.context(), CL_MEM_READ_WRITE, bytes, 0);
+                if (!in || !tmp || !out)
+                    throw std::runtime_error("clSVMAlloc failed");
+                svmMemcpy(env, in, input.data(), bytes);
+                k.enqueue(env, in, tmp, out);
+                svmMemcpy(env, output.data(), out, bytes);
+                clSVMFree(env.context(), in);
+                clSVMFree(env.context(), tmp);
+                clSVMFree(env.context(), out);
+                errors += checkFrame(output, f) ? 0 : 1;
+            }
+            double t = secondsSince(t0);
+            failures += errors;
+            printf("%-16s %8.3f ms/frame  %s\n", "alloc/free", t / frames * 1e3, errors == 0 ? "ok" : "MISMATCH");
+        }
+
+        for (int depth : {1, 2, 3}) {
+            SvmFrameRing ring(env, 3 * bytes + 3 * 4096, depth);
+            std::vector<std::vector<float>> inputs(depth, std::vector<float>(elems)), outputs(depth, std::vector<float>(elems));
+            std::vector<int> frameOf(depth, -1);
+            int errors = 0;
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (int f = 0; f < frames; ++f) {
+                SvmFrameArena& arena = ring.begin();
+                int slot = ring.current();
+                // the frame that used this arena (and its host buffers) is done
+                if (frameOf[slot] >= 0)
+                    errors += checkFrame(outputs[slot], frameOf[slot]) ? 0 : 1;
+                frameOf[slot] = f;
+
+                prepare(inputs[slot], f);
+                float* in = arena.allocate<float>(elems);
+                float* tmp = arena.allocate<float>(elems);
+                float* out = arena.allocate<float>(elems);
+                svmCopyAsync(env, in, inputs[slot].data(), bytes);
+                k.enqueue(env, in, tmp, out);
+                ring.end(svmCopyAsync(env, outputs[slot].data(), out, bytes));
+                env.queue.flush();
+            }
+            ring.drain();
+            double t = secondsSince(t0);
+            for (int s = 0; s < depth; ++s)
+                if (frameOf[s] >= 0)
+                    errors += checkFrame(outputs[s], frameOf[s]) ? 0 : 1;
+            failures += errors;
+            printf("arena ring x%d    %8.3f ms/frame  stalls %4zu/%zu  %s\n", depth, t / frames * 1e3, ring.stalls(),
+                   ring.frames(), errors == 0 ? "ok" : "MISMATCH");
+        }
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
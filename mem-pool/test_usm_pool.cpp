@@ -0,0 +1,174 @@
+// USM pool against calling the driver allocators directly.
+//
+//   latency   a working set of 16 live blocks, free the oldest and allocate a
+//             new one of random size (256 B .. 4 MB), per kind
+//   frames    per frame: device in/out, copy in, kernel, copy out, deferred
+//             free tied to the last copy; at most `depth` frames in flight,
+//             frame f waits for frame f - depth and checks its result. Once
+//             the pipeline is warm, driver allocations must not grow
+//   stl       std::vector over shared USM, passed straight to a kernel
+//
+// usage: ./app [iterations] [frames] [frame_elems] [depth]
+
+#include "../primitives/ocl_env.h"
+#include "usm_pool.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <random>
+
+static const char* scaleSource = R"(
+__kernel void scale(__global const float* in, __global float* out, float s, uint n)
+{
+    uint i = get_global_id(0);
+    if (i < n)
+        out[i] = in[i] * s;
+}
+)";
+
+struct Block {
+    void* ptr;
+    size_t bytes;
+};
+
+// mean allocation latency in us over `iterations` replace-oldest steps
+template <typename Alloc, typename Free>
+static double churn(int iterations, std::mt19937& rng, Alloc&& alloc, Free&& release) {
+    static const size_t sizes[] = {256, 4096, 65536, 1 << 20, 4 << 20};
+    std::deque<Block> live;
+    double total = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        if (live.size() == 16) {
+            release(live.front());
+            live.pop_front();
+        }
+        size_t bytes = sizes[rng() % 5] - rng() % 128;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        void* ptr = alloc(bytes);
+        total += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+        live.push_back(Block{ptr, bytes});
+    }
+    for (Block& b : live)
+        release(b);
+    return total / iterations * 1e6;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+    int frames = argc > 2 ? atoi(argv[2]) : 256;
+    uint32_t elems = argc > 3 ? (uint32_t)strtoul(argv[3], nullptr, 10) : 1u << 20;
+    int depth = std::max(1, argc > 4 ? atoi(argv[4]) : 3);
+
+    try {
+        OclEnv env = OclEnv::create();
+        const UsmApi& api = env.usmApi;
+        if (!api.available()) {
+            std::cout << "Platform does not export the USM entry points (cl_intel_unified_shared_memory)." << std::endl;
+            return 1;
+        }
+        UsmPool pool(env.context, env.device, api);
+        std::mt19937 rng(1);
+        int failures = 0;
+
+        printf("%-8s %14s %14s %8s\n", "kind", "driver_us", "pool_us", "speedup");
+        for (UsmKind kind : {UsmKind::Host, UsmKind::Device, UsmKind::Shared}) {
+            double tDriver = churn(iterations, rng, [&](size_t bytes) { return api.alloc(kind, env.context, env.device, bytes); },
+                                   [&](Block& b) { api.memBlockingFree(env.context(), b.ptr); });
+            auto poolAlloc = [&](size_t bytes) { return pool.allocate(kind, bytes); };
+            auto poolFree = [&](Block& b) { pool.deallocate(b.ptr, kind, b.bytes); };
+            churn(64, rng, poolAlloc, poolFree);   // warm the free lists
+            double tPool = churn(iterations, rng, poolAlloc, poolFree);
+            printf("%-8s %14.3f %14.3f %7.0fx\n", usmKindName(kind), tDriver, tPool, tDriver / tPool);
+        }
+
+        // frames with deferred frees
+        cl::Program program = buildProgram(env, scaleSource);
+        cl::Kernel kernel(program, "scale");
+        size_t bytes = elems * sizeof(float);
+        std::vector<float> input(elems);
+        for (uint32_t i = 0; i < elems; ++i)
+            input[i] = (float)(i % 1024);
+        // one host result buffer and completion event per frame in flight
+        std::vector<std::vector<float>> results(depth, std::vector<float>(elems));
+        std::vector<cl::Event> frameDone(depth);
+        std::vector<int> frameOf(depth, -1);
+        int errors = 0;
+        auto checkSlot = [&](int slot) {
+            int f = frameOf[slot];
+            for (uint32_t i = 0; i < elems; i += 997)
+                if (results[slot][i] != input[i] * (float)(f % 7 + 1))
+                    errors++;
+        };
+        UsmPool::Stats before = pool.stats(), warm = before;
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (int f = 0; f < frames; ++f) {
+            int slot = f % depth;
+            if (frameOf[slot] >= 0) {
+                frameDone[slot].wait();
+                checkSlot(slot);
+            }
+            // from here on every block frame f needs was freed by frame f - depth
+            if (f == depth)
+                warm = pool.stats();
+            frameOf[slot] = f;
+
+            float* in = static_cast<float*>(pool.allocate(UsmKind::Device, bytes));
+            float* out = static_cast<float*>(pool.allocate(UsmKind::Device, bytes));
+            api.memcpy(env.queue, in, input.data(), bytes, false);
+            api.setArg(kernel, 0, in);
+            api.setArg(kernel, 1, out);
+            kernel.setArg(2, (float)(f % 7 + 1));
+            kernel.setArg(3, (cl_uint)elems);
+            env.queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange((elems + 255) / 256 * 256), cl::NullRange);
+            cl_event last = nullptr;
+            cl_int err = api.enqueueMemcpy(env.queue(), CL_FALSE, results[slot].data(), out, bytes, 0, nullptr, &last);
+            if (err != CL_SUCCESS)
+                throw std::runtime_error("clEnqueueMemcpyINTEL failed: " + std::to_string(err));
+            frameDone[slot] = cl::Event(last);
+            pool.deallocate(in, UsmKind::Device, bytes, frameDone[slot]);
+            pool.deallocate(out, UsmKind::Device, bytes, frameDone[slot]);
+            env.queue.flush();
+        }
+        env.queue.finish();
+        double tFrames = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+        UsmPool::Stats after = pool.stats();
+        for (int slot = 0; slot < depth; ++slot)
+            if (frameOf[slot] >= 0)
+                checkSlot(slot);
+        size_t steadyAllocs = frames > depth ? after.driverAllocs - warm.driverAllocs : 0;
+        failures += errors + (steadyAllocs == 0 ? 0 : 1);
+        printf("\nframes: %d x %.1f MB, %d in flight, in %.2f ms, driver allocs %zu (%zu after warm-up), pool hits %zu, "
+               "deferred pending %zu  %s\n",
+               frames, bytes / 1e6, depth, tFrames * 1e3, after.driverAllocs - before.driverAllocs, steadyAllocs,
+               after.poolHits - before.poolHits, after.deferredPending,
+               errors != 0 ? "MISMATCH" : steadyAllocs != 0 ? "ALLOCS GROWING" : "ok");
+        pool.collect();
+
+        // STL containers in shared USM
+        {
+            UsmAllocator<float> alloc(pool);
+            UsmVector<float> a(elems, 2.f, alloc), b(elems, 0.f, alloc);
+            api.setArg(kernel, 0, a.data());
+            api.setArg(kernel, 1, b.data());
+            kernel.setArg(2, 1.5f);
+            kernel.setArg(3, (cl_uint)elems);
+            env.queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange((elems + 255) / 256 * 256), cl::NullRange);
+            env.queue.finish();
+            errors = 0;
+            for (float v : b)
+                if (v != 3.f) errors++;
+            failures += errors;
+            printf("stl vector in shared USM: %s\n", errors == 0 ? "ok" : "MISMATCH");
+        }
+
+        UsmPool::Stats s = pool.stats();
+        printf("pool: %zu driver allocs, %zu hits, %.1f MB cached, %.1f MB live\n", s.driverAllocs, s.poolHits,
+               s.cachedBytes / 1e6, s.liveBytes / 1e6);
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
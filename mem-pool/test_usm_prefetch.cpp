@@ -0,0 +1,100 @@
+// Shared USM with and without migration hints. Every iteration the host
+// writes the inputs (pages move to the host), a kernel computes
+// out = a * 2 + b on the device and the host reads `out` back, the pattern of
+// test_usm_device-multi-devices.cpp. Without hints the kernel faults the
+// pages over; with UsmScheduler they are migrated before the launch and back
+// before the host read.
+//
+//   kernel   device execution time from profiling events
+//   total    host write + launch + host read, wall clock
+//
+// usage: ./app [elems] [iterations]
+
+#include "../primitives/ocl_env.h"
+#include "usm_prefetch.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+static const char* axpySource = R"(
+__kernel void axpy(__global const float* a, __global const float* b, __global float* out, uint n)
+{
+    uint i = get_global_id(0);
+    if (i < n)
+        out[i] = a[i] * 2.f + b[i];
+}
+)";
+
+int main(int argc, char** argv) {
+    uint32_t elems = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 16u << 20;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    try {
+        OclEnv env = OclEnv::create(true, CL_QUEUE_PROFILING_ENABLE);
+        const UsmApi& api = env.usmApi;
+        if (!api.available()) {
+            std::cout << "Platform does not export the USM entry points (cl_intel_unified_shared_memory)." << std::endl;
+            return 1;
+        }
+        UsmScheduler sched(api, env.device);
+        std::cout << "migration hints: " << (sched.active() ? "clEnqueueMigrateMemINTEL" : "not available, no-op") << std::endl;
+
+        size_t bytes = elems * sizeof(float);
+        float* a = static_cast<float*>(api.alloc(UsmKind::Shared, env.context, env.device, bytes));
+        float* b = static_cast<float*>(api.alloc(UsmKind::Shared, env.context, env.device, bytes));
+        float* out = static_cast<float*>(api.alloc(UsmKind::Shared, env.context, env.device, bytes));
+
+        cl::Program program = buildProgram(env, axpySource);
+        cl::Kernel kernel(program, "axpy");
+        api.setArg(kernel, 0, a);
+        api.setArg(kernel, 1, b);
+        api.setArg(kernel, 2, out);
+        kernel.setArg(3, (cl_uint)elems);
+        cl::NDRange global((elems + 255) / 256 * 256), local(256);
+        std::vector<UsmRange> inputs = {{a, bytes, UsmAccess::Read}, {b, bytes, UsmAccess::Read}, {out, bytes, UsmAccess::Write}};
+        std::vector<UsmRange> outputs = {{out, bytes, UsmAccess::Read}};
+        int failures = 0;
+
+        for (bool hints : {false, true}) {
+            sched.setEnabled(hints);
+            std::vector<double> kernelTimes, totals;
+            int errors = 0;
+            for (int it = 0; it < iterations; ++it) {
+                auto t0 = std::chrono::high_resolution_clock::now();
+                for (uint32_t i = 0; i < elems; ++i) {
+                    a[i] = (float)((i + it) % 1000);
+                    b[i] = 1.f;
+                }
+                cl::Event ev;
+                sched.launch(env.queue, kernel, global, local, inputs, &ev);
+                sched.toHost(env.queue, outputs);
+                double sum = 0.0;
+                for (uint32_t i = 0; i < elems; i += 64)
+                    sum += out[i];
+                totals.push_back(std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count());
+                kernelTimes.push_back((ev.getProfilingInfo<CL_PROFILING_COMMAND_END>() -
+                                       ev.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1e-9);
+
+                double ref = 0.0;
+                for (uint32_t i = 0; i < elems; i += 64)
+                    ref += (float)((i + it) % 1000) * 2.f + 1.f;
+                if (std::abs(sum - ref) > 1e-6 * ref)
+                    errors++;
+            }
+            failures += errors;
+            printf("%-9s kernel %8.3f ms   total %8.3f ms   %s\n", hints ? "hints" : "no hints", medianOf(kernelTimes) * 1e3,
+                   medianOf(totals) * 1e3, errors == 0 ? "ok" : "MISMATCH");
+        }
+        printf("migrations issued: %zu\n", sched.migrations());
+
+        api.memBlockingFree(env.context(), a);
+        api.memBlockingFree(env.context(), b);
+        api.memBlockingFree(env.context(), out);
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
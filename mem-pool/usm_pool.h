@@ -0,0 +1,221 @@
+#pragma once
+
+// Caching pool over the Intel USM allocators, one per context/device, with
+// separate host, device and shared heaps.
+//
+// Requests are rounded up to a power-of-two size class (256 B .. 64 MB); each
+// heap keeps a free list per class, so once warm an allocation is a free-list
+// pop and a free a push, with no driver call. Frees are sized (the caller,
+// or the STL allocator, passes the size back), so there is no per-pointer
+// bookkeeping on the hot path. Larger requests go straight to the driver.
+//
+// deallocate(ptr, kind, bytes, event) defers the free until `event` (the last
+// command using the memory) completes; deferred blocks are retired by
+// collect(), which allocate() runs by itself when a free list is empty.
+//
+//     UsmPool pool(env.context, env.device, env.usmApi);
+//     void* d = pool.allocate(UsmKind::Device, bytes);
+//     ... kernel writing d, event ev ...
+//     pool.deallocate(d, UsmKind::Device, bytes, ev);
+//
+//     UsmVector<float> v(n, 0.f, UsmAllocator<float>(pool));   // shared USM
+
+#include "../primitives/usm_api.h"
+
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+class UsmPool {
+public:
+    static const size_t MIN_CLASS_BYTES = 256;
+    static const int NUM_CLASSES = 19;   // 256 B << 18 = 64 MB
+
+    struct Stats {
+        size_t driverAllocs = 0;
+        size_t driverFrees = 0;
+        size_t poolHits = 0;
+        size_t deferredPending = 0;
+        size_t cachedBytes = 0;
+        size_t liveBytes = 0;
+    };
+
+    UsmPool(const cl::Context& context, const cl::Device& device, const UsmApi& api)
+        : context_(context), device_(device), api_(api) {
+        if (!api.available())
+            throw std::runtime_error("UsmPool: USM entry points not available");
+    }
+    UsmPool(const UsmPool&) = delete;
+    UsmPool& operator=(const UsmPool&) = delete;
+
+    ~UsmPool() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Pending& p : pending_) {
+            p.event.wait();
+            release(p.kind, p.cls, p.ptr);
+        }
+        pending_.clear();
+        for (int k = 0; k < 3; ++k)
+            for (int c = 0; c < NUM_CLASSES; ++c)
+                for (void* ptr : heaps_[k].free[c])
+                    api_.memBlockingFree(context_(), ptr);
+        if (stats_.liveBytes)
+            std::cerr << "UsmPool: " << stats_.liveBytes << " bytes still allocated at destruction" << std::endl;
+    }
+
+    const UsmApi& api() const { return api_; }
+
+    // -1: larger than the biggest class
+    static int sizeClass(size_t bytes) {
+        if (bytes <= MIN_CLASS_BYTES)
+            return 0;
+        int c = 64 - __builtin_clzll((unsigned long long)(bytes - 1)) - 8;
+        return c < NUM_CLASSES ? c : -1;
+    }
+    static size_t classBytes(int cls) { return MIN_CLASS_BYTES << cls; }
+
+    void* allocate(UsmKind kind, size_t bytes) {
+        int cls = sizeClass(bytes);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cls >= 0) {
+            std::vector<void*>& list = heaps_[(int)kind].free[cls];
+            if (list.empty() && !pending_.empty())
+                collectLocked();
+            if (!list.empty()) {
+                void* ptr = list.back();
+                list.pop_back();
+                stats_.poolHits++;
+                stats_.cachedBytes -= classBytes(cls);
+                stats_.liveBytes += classBytes(cls);
+                return ptr;
+            }
+        }
+        size_t size = cls >= 0 ? classBytes(cls) : bytes;
+        void* ptr = api_.alloc(kind, context_, device_, size);
+        stats_.driverAllocs++;
+        stats_.liveBytes += size;
+        return ptr;
+    }
+
+    // immediately reusable: no command may still use ptr
+    void deallocate(void* ptr, UsmKind kind, size_t bytes) {
+        if (!ptr)
+            return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        int cls = sizeClass(bytes);
+        stats_.liveBytes -= cls >= 0 ? classBytes(cls) : bytes;
+        release(kind, cls, ptr);
+    }
+
+    // reusable once lastUse has completed
+    void deallocate(void* ptr, UsmKind kind, size_t bytes, const cl::Event& lastUse) {
+        if (!ptr)
+            return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        int cls = sizeClass(bytes);
+        stats_.liveBytes -= cls >= 0 ? classBytes(cls) : bytes;
+        pending_.push_back(Pending{lastUse, ptr, kind, cls});
+    }
+
+    // retires deferred frees whose events completed; returns how many
+    size_t collect() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return collectLocked();
+    }
+
+    // returns every cached block to the driver
+    void trim() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        collectLocked();
+        for (int k = 0; k < 3; ++k)
+            for (int c = 0; c < NUM_CLASSES; ++c) {
+                for (void* ptr : heaps_[k].free[c]) {
+                    api_.memFree(context_(), ptr);
+                    stats_.driverFrees++;
+                }
+                heaps_[k].free[c].clear();
+            }
+        stats_.cachedBytes = 0;
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Stats s = stats_;
+        s.deferredPending = pending_.size();
+        return s;
+    }
+
+private:
+    struct Heap {
+        std::vector<void*> free[NUM_CLASSES];
+    };
+    struct Pending {
+        cl::Event event;
+        void* ptr;
+        UsmKind kind;
+        int cls;
+    };
+
+    void release(UsmKind kind, int cls, void* ptr) {
+        if (cls < 0) {
+            api_.memFree(context_(), ptr);
+            stats_.driverFrees++;
+            return;
+        }
+        heaps_[(int)kind].free[cls].push_back(ptr);
+        stats_.cachedBytes += classBytes(cls);
+    }
+
+    size_t collectLocked() {
+        size_t retired = 0;
+        for (size_t i = 0; i < pending_.size();) {
+            // negative status: the command failed, the memory is idle as well
+            if (pending_[i].event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() <= CL_COMPLETE) {
+                Pending& p = pending_[i];
+                release(p.kind, p.cls, p.ptr);
+                pending_[i] = pending_.back();
+                pending_.pop_back();
+                retired++;
+            } else {
+                ++i;
+            }
+        }
+        return retired;
+    }
+
+    cl::Context context_;
+    cl::Device device_;
+    UsmApi api_;
+    Heap heaps_[3];
+    std::vector<Pending> pending_;
+    Stats stats_;
+    std::mutex mutex_;
+};
+
+// STL allocator over one pool; host-accessible kinds only
+template <typename T, UsmKind Kind = UsmKind::Shared>
+class UsmAllocator {
+public:
+    static_assert(Kind != UsmKind::Device, "device USM is not accessible from the host");
+    typedef T value_type;
+    template <typename U> struct rebind { typedef UsmAllocator<U, Kind> other; };
+
+    explicit UsmAllocator(UsmPool& pool) : pool_(&pool) {}
+    template <typename U> UsmAllocator(const UsmAllocator<U, Kind>& other) : pool_(other.pool()) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(pool_->allocate(Kind, n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { pool_->deallocate(p, Kind, n * sizeof(T)); }
+
+    UsmPool* pool() const { return pool_; }
+
+private:
+    UsmPool* pool_;
+};
+
+template <typename T, typename U, UsmKind K>
+bool operator==(const UsmAllocator<T, K>& a, const UsmAllocator<U, K>& b) { return a.pool() == b.pool(); }
+template <typename T, typename U, UsmKind K>
+bool operator!=(const UsmAllocator<T, K>& a, const UsmAllocator<U, K>& b) { return a.pool() != b.pool(); }
+
+template <typename T, UsmKind Kind = UsmKind::Shared>
+using UsmVector = std::vector<T, UsmAllocator<T, Kind>>;
@@ -0,0 +1,84 @@
+#pragma once
+
+// Migration hints for shared USM, so kernels do not page-fault their inputs
+// over one page at a time.
+//
+// Each launch declares the shared ranges the kernel touches. Before the
+// kernel, the scheduler enqueues clEnqueueMigrateMemINTEL for each range on
+// the same queue, which moves it to the queue's device ahead of time.
+// Write-only ranges are migrated with CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED
+// so the old contents are not copied. toHost() migrates ranges back before
+// the host reads them. An optional clEnqueueMemAdviseINTEL value is issued
+// for read ranges. The extension defines no portable advice values, so the
+// caller supplies a driver-specific one, or none.
+//
+// Without clEnqueueMigrateMemINTEL (non-Intel ICDs, older drivers), or on a
+// CPU device where nothing moves, every hint is a no-op and launch() is a
+// plain enqueueNDRangeKernel.
+
+#include "../primitives/usm_api.h"
+
+#include <vector>
+
+#ifndef CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED
+#define CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED (1 << 1)
+#endif
+
+enum class UsmAccess { Read, Write, ReadWrite };
+
+struct UsmRange {
+    const void* ptr;
+    size_t bytes;
+    UsmAccess access;
+};
+
+class UsmScheduler {
+public:
+    UsmScheduler(const UsmApi& api, const cl::Device& device) : api_(api) {
+        active_ = api.enqueueMigrateMem != nullptr && (device.getInfo<CL_DEVICE_TYPE>() & CL_DEVICE_TYPE_CPU) == 0;
+    }
+
+    bool active() const { return active_; }
+    size_t migrations() const { return migrations_; }
+    void setEnabled(bool on) { enabled_ = on; }
+    // 0: no advice
+    void setReadAdvice(cl_uint advice) { readAdvice_ = advice; }
+
+    // hints for `ranges`, then the kernel; `event` is the kernel's
+    cl_int launch(cl::CommandQueue& queue, cl::Kernel& kernel, const cl::NDRange& global, const cl::NDRange& local,
+                  const std::vector<UsmRange>& ranges, cl::Event* event = nullptr) {
+        if (on()) {
+            for (const UsmRange& r : ranges) {
+                cl_mem_migration_flags flags = r.access == UsmAccess::Write ? CL_MIGRATE_MEM_OBJECT_CONTENT_UNDEFINED : 0;
+                migrate(queue, r, flags);
+                if (readAdvice_ && r.access != UsmAccess::Write && api_.enqueueMemAdvise)
+                    api_.enqueueMemAdvise(queue(), r.ptr, r.bytes, readAdvice_, 0, nullptr, nullptr);
+            }
+        }
+        return queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, event);
+    }
+
+    // back to the host before host code reads `ranges`; waits for the queue
+    void toHost(cl::CommandQueue& queue, const std::vector<UsmRange>& ranges) {
+        if (on())
+            for (const UsmRange& r : ranges)
+                migrate(queue, r, CL_MIGRATE_MEM_OBJECT_HOST);
+        queue.finish();
+    }
+
+private:
+    bool on() const { return active_ && enabled_; }
+
+    void migrate(cl::CommandQueue& queue, const UsmRange& r, cl_mem_migration_flags flags) {
+        cl_int err = api_.enqueueMigrateMem(queue(), r.ptr, r.bytes, flags, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("clEnqueueMigrateMemINTEL failed: " + std::to_string(err));
+        migrations_++;
+    }
+
+    UsmApi api_;
+    bool active_ = false;
+    bool enabled_ = true;
+    cl_uint readAdvice_ = 0;
+    size_t migrations_ = 0;
+};
@@ -0,0 +1,22 @@
+sudo apt install opencl-header ocl-icd-opencl-dev
+
+# USM pool: host/device/shared heaps with size classes, deferred frees, STL allocator
+# (needs cl_intel_unified_shared_memory; entry points are resolved at runtime)
+source build.sh test_usm_pool.cpp
+./app 20000 256 1048576 3 2>&1 | tee mylog
+
+# shared USM with clEnqueueMigrateMemINTEL hints before launches / host reads vs page faults
+source build.sh test_usm_prefetch.cpp
+./app 16777216 20 2>&1 | tee mylog
+
+# sub-buffer arena (bump with per-frame reset, buddy) vs one cl::Buffer per array
+source build.sh test_buffer_arena.cpp
+./app 1000 6 262144 2>&1 | tee mylog
+
+# per-frame SVM bump arenas with bulk reset on the frame's last event, 1/2/3-arena rotation
+source build.sh test_svm_frame_arena.cpp
+./app 500 1048576 2>&1 | tee mylog
+
+# pageable enqueueWrite/ReadBuffer vs chunked transfers through a ring of mapped pinned buffers, 1 MB .. 1 GB
+source build.sh test_staging_ring.cpp
+./app 1024 8 4 2 2>&1 | tee mylog
@@ -0,0 +1,309 @@
+// OSU-style latency / bandwidth microbenchmark for MPI with device memory.
+//
+// ops:    pt2pt (ping-pong between rank 0 and 1), bcast, allreduce, alltoall
+// memory: host      plain host memory handed to MPI
+//         buffer    cl::Buffer, staged through host with enqueueRead/WriteBuffer
+//         svm       coarse-grain SVM, mapped around each MPI call
+//         usm       Intel USM shared allocation handed straight to MPI
+//
+// Output is CSV, one line per (op, memory, size):
+//   op,memory,bytes,iterations,latency_us,bandwidth_MBps
+//
+// usage: mpirun -np 4 ./app [--max bytes] [--min bytes] [--ops pt2pt,bcast,...] [--mem host,svm,...] [--csv file]
+
+#include <mpi.h>
+#include <CL/cl2.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// USM entry points are resolved at runtime, no Intel headers needed
+#include "../primitives/usm_api.h"
+
+struct BenchEnv {
+    cl::Platform platform;
+    cl::Device device;
+    cl::Context context;
+    cl::CommandQueue queue;
+    UsmApi usmApi;
+};
+
+// memory under test, ptr() is what gets handed to MPI
+class BenchMem {
+public:
+    virtual ~BenchMem() {}
+    virtual void* ptr() = 0;
+    // make device data visible to MPI before sending
+    virtual void beforeMpi(size_t bytes, bool send) {}
+    // push received data back to the device
+    virtual void afterMpi(size_t bytes, bool recv) {}
+};
+
+class HostMem : public BenchMem {
+public:
+    HostMem(size_t bytes) : data_(bytes, 1) {}
+    void* ptr() override { return data_.data(); }
+private:
+    std::vector<char> data_;
+};
+
+class BufferMem : public BenchMem {
+public:
+    BufferMem(BenchEnv& env, size_t bytes) : env_(env), staging_(bytes, 1),
+        buffer_(env.context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, bytes, staging_.data()) {}
+    void* ptr() override { return staging_.data(); }
+    void beforeMpi(size_t bytes, bool send) override {
+        if (send)
+            env_.queue.enqueueReadBuffer(buffer_, CL_TRUE, 0, bytes, staging_.data());
+    }
+    void afterMpi(size_t bytes, bool recv) override {
+        if (recv)
+            env_.queue.enqueueWriteBuffer(buffer_, CL_TRUE, 0, bytes, staging_.data());
+    }
+private:
+    BenchEnv& env_;
+    std::vector<char> staging_;
+    cl::Buffer buffer_;
+};
+
+class SvmMem : public BenchMem {
+public:
+    SvmMem(BenchEnv& env, size_t bytes) : env_(env) {
+        ptr_ = clSVMAlloc(env.context(), CL_MEM_READ_WRITE, bytes, 0);
+        if (!ptr_)
+            throw std::runtime_error("clSVMAlloc failed");
+        clEnqueueSVMMap(env_.queue(), CL_TRUE, CL_MAP_WRITE, ptr_, bytes, 0, nullptr, nullptr);
+        memset(ptr_, 1, bytes);
+        clEnqueueSVMUnmap(env_.queue(), ptr_, 0, nullptr, nullptr);
+        env_.queue.finish();
+    }
+    ~SvmMem() { clSVMFree(env_.context(), ptr_); }
+    void* ptr() override { return ptr_; }
+    void beforeMpi(size_t bytes, bool send) override {
+        cl_map_flags flags = send ? CL_MAP_READ | CL_MAP_WRITE : CL_MAP_WRITE_INVALIDATE_REGION;
+        clEnqueueSVMMap(env_.queue(), CL_TRUE, flags, ptr_, bytes, 0, nullptr, nullptr);
+    }
+    void afterMpi(size_t bytes, bool recv) override {
+        clEnqueueSVMUnmap(env_.queue(), ptr_, 0, nullptr, nullptr);
+        env_.queue.finish();
+    }
+private:
+    BenchEnv& env_;
+    void* ptr_ = nullptr;
+};
+
+class UsmMem : public BenchMem {
+public:
+    UsmMem(BenchEnv& env, size_t bytes) : env_(env) {
+        ptr_ = env.usmApi.alloc(UsmKind::Shared, env.context, env.device, bytes);
+        memset(ptr_, 1, bytes);
+    }
+    ~UsmMem() { env_.usmApi.memFree(env_.context(), ptr_); }
+    void* ptr() override { return ptr_; }
+private:
+    BenchEnv& env_;
+    void* ptr_ = nullptr;
+};
+
+static std::unique_ptr<BenchMem> makeMem(BenchEnv& env, const std::string& kind, size_t bytes) {
+    bytes = std::max<size_t>(bytes, 1);
+    if (kind == "host")
+        return std::unique_ptr<BenchMem>(new HostMem(bytes));
+    if (kind == "buffer")
+        return std::unique_ptr<BenchMem>(new BufferMem(env, bytes));
+    if (kind == "svm")
+        return std::unique_ptr<BenchMem>(new SvmMem(env, bytes));
+    if (kind == "usm")
+        return std::unique_ptr<BenchMem>(new UsmMem(env, bytes));
+    throw std::runtime_error("unknown memory kind: " + kind);
+}
+
+static bool memSupported(BenchEnv& env, const std::string& kind) {
+    if (kind == "svm") {
+        cl_device_svm_capabilities caps = 0;
+        clGetDeviceInfo(env.device(), CL_DEVICE_SVM_CAPABILITIES, sizeof(caps), &caps, nullptr);
+        return (caps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER) != 0;
+    }
+    if (kind == "usm")
+        return env.usmApi.available();
+    return true;
+}
+
+static int iterationsFor(size_t bytes) {
+    // ~100 MB moved per point, clamped to [10, 1000]
+    long long iters = 100LL * 1024 * 1024 / (long long)std::max<size_t>(bytes, 1);
+    return (int)std::min<long long>(1000, std::max<long long>(10, iters));
+}
+
+// returns the per-operation time in seconds, max over ranks
+static double runOp(const std::string& op, BenchMem& sbuf, BenchMem& rbuf, size_t bytes, int iters, int rank, int size) {
+    const int warmup = iters / 10 + 1;
+    const int count = (int)std::max<size_t>(bytes / sizeof(float), 1);
+    double t0 = 0.0;
+
+    for (int it = 0; it < warmup + iters; ++it) {
+        if (it == warmup) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            t0 = MPI_Wtime();
+        }
+        if (op == "pt2pt") {
+            if (rank == 0) {
+                sbuf.beforeMpi(bytes, true);
+                MPI_Send(sbuf.ptr(), (int)bytes, MPI_BYTE, 1, 0, MPI_COMM_WORLD);
+                sbuf.afterMpi(bytes, false);
+                rbuf.beforeMpi(bytes, false);
+                MPI_Recv(rbuf.ptr(), (int)bytes, MPI_BYTE, 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                rbuf.afterMpi(bytes, true);
+            } else if (rank == 1) {
+                rbuf.beforeMpi(bytes, false);
+                MPI_Recv(rbuf.ptr(), (int)bytes, MPI_BYTE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                rbuf.afterMpi(bytes, true);
+                sbuf.beforeMpi(bytes, true);
+                MPI_Send(sbuf.ptr(), (int)bytes, MPI_BYTE, 0, 0, MPI_COMM_WORLD);
+                sbuf.afterMpi(bytes, false);
+            }
+        } else if (op == "bcast") {
+            sbuf.beforeMpi(bytes, rank == 0);
+            MPI_Bcast(sbuf.ptr(), (int)bytes, MPI_BYTE, 0, MPI_COMM_WORLD);
+            sbuf.afterMpi(bytes, rank != 0);
+        } else if (op == "allreduce") {
+            sbuf.beforeMpi(bytes, true);
+            rbuf.beforeMpi(bytes, false);
+            MPI_Allreduce(sbuf.ptr(), rbuf.ptr(), count, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+            sbuf.afterMpi(bytes, false);
+            rbuf.afterMpi(bytes, true);
+        } else if (op == "alltoall") {
+            size_t total = bytes * size;
+            sbuf.beforeMpi(total, true);
+            rbuf.beforeMpi(total, false);
+            MPI_Alltoall(sbuf.ptr(), (int)bytes, MPI_BYTE, rbuf.ptr(), (int)bytes, MPI_BYTE, MPI_COMM_WORLD);
+            sbuf.afterMpi(total, false);
+            rbuf.afterMpi(total, true);
+        }
+    }
+
+    double local = (MPI_Wtime() - t0) / iters;
+    // ping-pong: one-way latency is half the round trip
+    if (op == "pt2pt")
+        local /= 2.0;
+    double global = 0.0;
+    MPI_Allreduce(&local, &global, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return global;
+}
+
+static std::vector<std::string> splitList(const std::string& s) {
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            out.push_back(item);
+    return out;
+}
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    size_t minBytes = 1;
+    size_t maxBytes = 4 * 1024 * 1024;
+    std::vector<std::string> ops = {"pt2pt", "bcast", "allreduce", "alltoall"};
+    std::vector<std::string> mems = {"host", "buffer", "svm", "usm"};
+    std::string csvFile;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key = argv[i];
+        if (key == "--max") maxBytes = strtoull(argv[i + 1], nullptr, 10);
+        else if (key == "--min") minBytes = std::max<size_t>(1, strtoull(argv[i + 1], nullptr, 10));
+        else if (key == "--ops") ops = splitList(argv[i + 1]);
+        else if (key == "--mem") mems = splitList(argv[i + 1]);
+        else if (key == "--csv") csvFile = argv[i + 1];
+    }
+
+    if (size < 2) {
+        std::cerr << "This program requires at least 2 processes" << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    FILE* csv = nullptr;
+    if (rank == 0) {
+        csv = csvFile.empty() ? stdout : fopen(csvFile.c_str(), "w");
+        if (!csv) {
+            std::cerr << "Failed to open " << csvFile << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+
+    try {
+        BenchEnv env;
+        std::vector<cl::Platform> platforms;
+        cl::Platform::get(&platforms);
+        if (platforms.empty()) {
+            throw std::runtime_error("No OpenCL platforms found");
+        }
+        env.platform = platforms[0];
+
+        std::vector<cl::Device> devices;
+        env.platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        if (devices.empty()) {
+            throw std::runtime_error("No OpenCL devices found");
+        }
+        env.device = devices[rank % devices.size()];
+        env.context = cl::Context(env.device);
+        env.queue = cl::CommandQueue(env.context, env.device);
+        env.usmApi = UsmApi::load(env.platform);
+        std::cout << "rank " << rank << " device: " << env.device.getInfo<CL_DEVICE_NAME>() << std::endl;
+
+        if (rank == 0) {
+            fprintf(csv, "op,memory,bytes,iterations,latency_us,bandwidth_MBps\n");
+            fflush(csv);
+        }
+
+        for (const auto& mem : mems) {
+            // every rank has to agree, otherwise collectives deadlock
+            int ok = memSupported(env, mem) ? 1 : 0;
+            int allOk = 0;
+            MPI_Allreduce(&ok, &allOk, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+            if (!allOk) {
+                if (rank == 0)
+                    std::cerr << "skip memory kind " << mem << ": not supported on all ranks" << std::endl;
+                continue;
+            }
+
+            // allocate for the largest size once, alltoall needs one slot per rank
+            auto sbuf = makeMem(env, mem, maxBytes * size);
+            auto rbuf = makeMem(env, mem, maxBytes * size);
+
+            for (const auto& op : ops) {
+                for (size_t bytes = minBytes; bytes <= maxBytes; bytes *= 2) {
+                    if (op == "allreduce" && bytes < sizeof(float))
+                        continue;
+                    int iters = iterationsFor(op == "alltoall" ? bytes * size : bytes);
+                    double t = runOp(op, *sbuf, *rbuf, bytes, iters, rank, size);
+                    if (rank == 0) {
+                        double mbps = (double)bytes / t / 1e6;
+                        fprintf(csv, "%s,%s,%zu,%d,%.3f,%.2f\n", op.c_str(), mem.c_str(), bytes, iters, t * 1e6, mbps);
+                        fflush(csv);
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    if (csv && csv != stdout)
+        fclose(csv);
+    MPI_Finalize();
+    return 0;
+}
@@ -0,0 +1,229 @@
+#pragma once
+
+// Non-blocking MPI + OpenCL progress engine.
+//
+// All MPI point-to-point calls are funnelled through a dedicated progress
+// thread which polls MPI_Request objects and cl::Event objects together.
+// Every posted operation returns a Completion (std::shared_future<void>),
+// operations can depend on cl::Events and on other Completions, and
+// Completions can be turned back into cl::UserEvents so a kernel can wait
+// for a receive without the host thread ever blocking.
+//
+// Requirements:
+//   - MPI initialised with at least MPI_THREAD_SERIALIZED, and the owner
+//     thread must not call MPI itself while the engine is running.
+//   - Queues producing the cl::Events we depend on must be flushed,
+//     otherwise the events never leave CL_QUEUED.
+
+#include <mpi.h>
+#include <CL/cl2.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class OclMpiProgress {
+public:
+    using Completion = std::shared_future<void>;
+
+    OclMpiProgress() : running_(true), thread_(&OclMpiProgress::loop, this) {}
+
+    ~OclMpiProgress() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    OclMpiProgress(const OclMpiProgress&) = delete;
+    OclMpiProgress& operator=(const OclMpiProgress&) = delete;
+
+    // MPI_Isend issued once every dependency has completed
+    Completion isend(const void* buf, int count, MPI_Datatype type, int dest, int tag, MPI_Comm comm,
+                     const std::vector<cl::Event>& cl_deps = {}, const std::vector<Completion>& deps = {}) {
+        return post(cl_deps, deps, [=](MPI_Request* req) {
+            MPI_Isend(buf, count, type, dest, tag, comm, req);
+        });
+    }
+
+    // MPI_Irecv issued once every dependency has completed
+    Completion irecv(void* buf, int count, MPI_Datatype type, int source, int tag, MPI_Comm comm,
+                     const std::vector<cl::Event>& cl_deps = {}, const std::vector<Completion>& deps = {}) {
+        return post(cl_deps, deps, [=](MPI_Request* req) {
+            MPI_Irecv(buf, count, type, source, tag, comm, req);
+        });
+    }
+
+    // completes when the OpenCL command behind ev completes
+    Completion track(const cl::Event& ev) {
+        return post({ev}, {}, nullptr);
+    }
+
+    // composite completion, e.g. "kernel done AND send done"
+    Completion whenAll(const std::vector<cl::Event>& cl_deps, const std::vector<Completion>& deps) {
+        return post(cl_deps, deps, nullptr);
+    }
+
+    // user event which becomes CL_COMPLETE together with c, usable in a
+    // wait list so a kernel or copy can be chained behind an MPI transfer
+    cl::UserEvent toUserEvent(const cl::Context& context, const Completion& c) {
+        cl::UserEvent ev(context);
+        auto op = std::make_shared<Op>();
+        op->deps.push_back(c);
+        op->user_event = ev;
+        op->has_user_event = true;
+        submit(op);
+        return ev;
+    }
+
+    // number of operations not completed yet
+    size_t pending() const {
+        return pending_.load();
+    }
+
+    // loop iterations of the progress thread, for diagnostics
+    size_t iterations() const {
+        return iterations_.load();
+    }
+
+private:
+    struct Op {
+        std::vector<cl::Event> cl_deps;
+        std::vector<Completion> deps;
+        std::function<void(MPI_Request*)> start;
+        MPI_Request req = MPI_REQUEST_NULL;
+        bool started = false;
+        std::promise<void> done;
+        cl::UserEvent user_event;
+        bool has_user_event = false;
+    };
+
+    Completion post(const std::vector<cl::Event>& cl_deps, const std::vector<Completion>& deps,
+                    std::function<void(MPI_Request*)> start) {
+        auto op = std::make_shared<Op>();
+        op->cl_deps = cl_deps;
+        op->deps = deps;
+        op->start = std::move(start);
+        Completion c = op->done.get_future().share();
+        submit(op);
+        return c;
+    }
+
+    void submit(const std::shared_ptr<Op>& op) {
+        pending_++;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            incoming_.push_back(op);
+        }
+        cv_.notify_one();
+    }
+
+    // 0: not ready, 1: ready, -1: failed
+    static int depsReady(Op& op, std::string& error) {
+        for (auto& ev : op.cl_deps) {
+            cl_int status = ev.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>();
+            if (status < 0) {
+                error = "OpenCL dependency failed, status = " + std::to_string(status);
+                return -1;
+            }
+            if (status != CL_COMPLETE)
+                return 0;
+        }
+        for (auto& c : op.deps) {
+            if (c.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                return 0;
+        }
+        // propagate failures of upstream completions
+        for (auto& c : op.deps) {
+            try {
+                c.get();
+            } catch (const std::exception& ex) {
+                error = ex.what();
+                return -1;
+            }
+        }
+        return 1;
+    }
+
+    static void finish(Op& op, const std::string& error) {
+        if (error.empty())
+            op.done.set_value();
+        else
+            op.done.set_exception(std::make_exception_ptr(std::runtime_error(error)));
+        if (op.has_user_event)
+            op.user_event.setStatus(error.empty() ? CL_COMPLETE : -1);
+    }
+
+    // true when op is finished and can be dropped
+    static bool advance(Op& op) {
+        std::string error;
+        if (!op.started) {
+            int ready = depsReady(op, error);
+            if (ready == 0)
+                return false;
+            if (ready < 0) {
+                finish(op, error);
+                return true;
+            }
+            if (op.start)
+                op.start(&op.req);
+            op.started = true;
+        }
+        if (op.req != MPI_REQUEST_NULL) {
+            int flag = 0;
+            MPI_Test(&op.req, &flag, MPI_STATUS_IGNORE);
+            if (!flag)
+                return false;
+        }
+        finish(op, error);
+        return true;
+    }
+
+    void loop() {
+        std::list<std::shared_ptr<Op>> active;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                if (active.empty())
+                    cv_.wait(lock, [this] { return !running_ || !incoming_.empty(); });
+                if (!running_ && active.empty() && incoming_.empty())
+                    break;
+                active.splice(active.end(), incoming_);
+            }
+            iterations_++;
+
+            bool progressed = false;
+            for (auto it = active.begin(); it != active.end();) {
+                if (advance(**it)) {
+                    it = active.erase(it);
+                    pending_--;
+                    progressed = true;
+                } else {
+                    ++it;
+                }
+            }
+            // nothing moved: back off a little instead of burning a core
+            if (!progressed)
+                std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::list<std::shared_ptr<Op>> incoming_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> iterations_{0};
+    bool running_;
+    std::thread thread_;
+};
@@ -0,0 +1,135 @@
+#include <mpi.h>
+#include <CL/cl2.hpp>
+#include "ocl_mpi_progress.h"
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+const char* kernelSource = R"(
+    __kernel void fillRank(__global int* a, const int rank, const int n)
+    {
+        int gid = get_global_id(0);
+        if (gid < n) {
+            a[gid] = rank * 100000 + gid;
+        }
+    }
+
+    __kernel void checkFrom(__global const int* a, const int rank, const int n, __global int* errors)
+    {
+        int gid = get_global_id(0);
+        if (gid < n && a[gid] != rank * 100000 + gid) {
+            atomic_inc(errors);
+        }
+    }
+)";
+
+// ring exchange: every rank produces data with a kernel, sends it to the next
+// rank and verifies what it got from the previous one on the device. The host
+// thread only posts work and then polls, MPI progress runs in the engine.
+int main(int argc, char** argv) {
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    if (provided < MPI_THREAD_SERIALIZED) {
+        std::cerr << "MPI_THREAD_SERIALIZED not supported, provided: " << provided << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    std::cout << "rank: " << rank << ", size: " << size << std::endl;
+
+    const int next = (rank + 1) % size;
+    const int prev = (rank + size - 1) % size;
+    const int dataSize = 1024 * 1024;
+    int errors = 0;
+
+    try {
+        std::vector<cl::Platform> platforms;
+        cl::Platform::get(&platforms);
+        if (platforms.empty()) {
+            throw std::runtime_error("No OpenCL platforms found");
+        }
+
+        // single box: all ranks share the first platform, spread over its GPUs
+        std::vector<cl::Device> devices;
+        platforms[0].getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        if (devices.empty()) {
+            throw std::runtime_error("No OpenCL devices found");
+        }
+        cl::Device device = devices[rank % devices.size()];
+        std::cout << "rank " << rank << " device: " << device.getInfo<CL_DEVICE_NAME>() << std::endl;
+
+        cl::Context context(device);
+        cl::CommandQueue queue(context, device);
+        cl::Program program(context, kernelSource);
+        program.build({device});
+
+        cl::Buffer bufSend(context, CL_MEM_READ_WRITE, sizeof(int) * dataSize);
+        cl::Buffer bufRecv(context, CL_MEM_READ_WRITE, sizeof(int) * dataSize);
+        cl::Buffer bufErrors(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, sizeof(int), &errors);
+        std::vector<int> hostSend(dataSize);
+        std::vector<int> hostRecv(dataSize);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t host_polls = 0;
+        {
+            OclMpiProgress progress;
+
+            // kernel -> read back -> send, all non-blocking
+            cl::Kernel fill(program, "fillRank");
+            fill.setArg(0, bufSend);
+            fill.setArg(1, rank);
+            fill.setArg(2, dataSize);
+            cl::Event evFill, evRead;
+            queue.enqueueNDRangeKernel(fill, cl::NullRange, cl::NDRange(dataSize), cl::NullRange, nullptr, &evFill);
+            std::vector<cl::Event> readDeps = {evFill};
+            queue.enqueueReadBuffer(bufSend, CL_FALSE, 0, sizeof(int) * dataSize, hostSend.data(), &readDeps, &evRead);
+            queue.flush();
+
+            auto sent = progress.isend(hostSend.data(), dataSize, MPI_INT, next, 0, MPI_COMM_WORLD, {evRead});
+            auto received = progress.irecv(hostRecv.data(), dataSize, MPI_INT, prev, 0, MPI_COMM_WORLD);
+
+            // recv -> upload -> check kernel, chained through a user event
+            cl::UserEvent evReceived = progress.toUserEvent(context, received);
+            std::vector<cl::Event> writeDeps = {evReceived};
+            cl::Event evWrite, evCheck;
+            queue.enqueueWriteBuffer(bufRecv, CL_FALSE, 0, sizeof(int) * dataSize, hostRecv.data(), &writeDeps, &evWrite);
+            cl::Kernel check(program, "checkFrom");
+            check.setArg(0, bufRecv);
+            check.setArg(1, prev);
+            check.setArg(2, dataSize);
+            check.setArg(3, bufErrors);
+            std::vector<cl::Event> checkDeps = {evWrite};
+            queue.enqueueNDRangeKernel(check, cl::NullRange, cl::NDRange(dataSize), cl::NullRange, &checkDeps, &evCheck);
+            queue.flush();
+
+            // "check kernel done AND send done"
+            auto all = progress.whenAll({evCheck}, {sent});
+
+            // host is free while the chain runs
+            while (all.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                host_polls++;
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+            all.get();
+            std::cout << "rank " << rank << " progress iterations: " << progress.iterations()
+                      << ", host polls: " << host_polls << std::endl;
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        auto ts_chain = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        printf("rank %d ts_chain: %ld \n", rank, ts_chain);
+
+        queue.enqueueReadBuffer(bufErrors, CL_TRUE, 0, sizeof(int), &errors);
+        std::cout << "rank " << rank << " data from rank " << prev << " "
+                  << (errors == 0 ? "successful" : "failed") << " (errors: " << errors << ")" << std::endl;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Finalize();
+    return errors == 0 ? 0 : 1;
+}
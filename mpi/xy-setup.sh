@@ -28,3 +28,12 @@ $ mpirun -np 4 ./app
     MPI_Finalized, Done
     MPI_Finalized, Done
     MPI_Finalized, Done
+
+# MPI progress thread + cl::Event chaining, single box
+source build_mpi.sh test_ocl_mpi-progress.cpp
+$ mpirun -np 4 ./app
+
+# latency/bandwidth for host, cl::Buffer, SVM and USM memory, CSV on rank 0
+source build_mpi.sh mpi_ocl_bench.cpp mpi_ocl_bench
+$ mpirun -np 4 ./mpi_ocl_bench --max 16777216 --csv bench.csv
+$ mpirun -np 2 ./mpi_ocl_bench --ops pt2pt --mem host,svm
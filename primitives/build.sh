@@ -0,0 +1,5 @@
+#!/usr/bin/bash
+
+target_file=$1
+
+g++ $target_file -o app -std=c++17 -O2 -pthread -L/usr/local/lib -lOpenCL
@@ -0,0 +1,184 @@
+#pragma once
+
+// Expression templates over device float arrays.
+//
+//     ExprContext ctx(env);
+//     DArray a(ctx, n), b(ctx, n), c(ctx, n), d(ctx, n);
+//     c = a + b - d * 2.f;
+//
+// builds a tree of BinOp / Scalar / DArray nodes at compile time; nothing runs
+// until the assignment. operator= walks the tree once, numbering distinct
+// arrays and scalars in order of appearance, and produces the expression text,
+// e.g. "((v0 + v1) - (v2 * s0))". That text is the shape: the context
+// compiles one kernel per shape and caches it, scalars are kernel arguments,
+// so `d * 3.f` reuses the `d * 2.f` kernel. The kernel loads every distinct
+// input once and writes the destination once, instead of one full memory pass
+// per operator. The destination may also be an input (c = c * 0.5f + a).
+
+#include "ocl_env.h"
+
+#include <map>
+
+namespace expr {
+
+class DArray;
+
+// collected while generating code
+struct ExprArgs {
+    std::vector<const DArray*> arrays;
+    std::vector<float> scalars;
+
+    int arrayIndex(const DArray* a) {
+        for (size_t i = 0; i < arrays.size(); ++i)
+            if (arrays[i] == a) return (int)i;
+        arrays.push_back(a);
+        return (int)arrays.size() - 1;
+    }
+};
+
+template <typename E>
+struct Expr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+class ExprContext {
+public:
+    explicit ExprContext(OclEnv& env) : env_(env) {}
+
+    OclEnv& env() { return env_; }
+    size_t kernelsBuilt() const { return kernels_.size(); }
+    size_t launches() const { return launches_; }
+
+    void evaluate(const DArray& dst, const std::string& code, const ExprArgs& args);
+
+private:
+    cl::Kernel& kernelFor(const std::string& code, size_t numArrays, size_t numScalars) {
+        auto it = kernels_.find(code);
+        if (it != kernels_.end())
+            return it->second.kernel;
+
+        std::string src = "__kernel void fused(__global float* out";
+        for (size_t i = 0; i < numArrays; ++i)
+            src += ", __global const float* a" + std::to_string(i);
+        for (size_t i = 0; i < numScalars; ++i)
+            src += ", float s" + std::to_string(i);
+        src += ", uint n)\n{\n    uint i = get_global_id(0);\n    if (i >= n)\n        return;\n";
+        for (size_t i = 0; i < numArrays; ++i)
+            src += "    float v" + std::to_string(i) + " = a" + std::to_string(i) + "[i];\n";
+        src += "    out[i] = " + code + ";\n}\n";
+
+        Fused f;
+        f.program = buildProgram(env_, src);
+        f.kernel = cl::Kernel(f.program, "fused");
+        return kernels_.emplace(code, f).first->second.kernel;
+    }
+
+    struct Fused {
+        cl::Program program;
+        cl::Kernel kernel;
+    };
+
+    OclEnv& env_;
+    std::map<std::string, Fused> kernels_;
+    size_t launches_ = 0;
+};
+
+class DArray : public Expr<DArray> {
+public:
+    DArray(ExprContext& ctx, size_t n, MemKind kind = MemKind::Buffer)
+        : ctx_(&ctx), n_(n), mem_(ctx.env(), kind, std::max<size_t>(n, 1) * sizeof(float)) {}
+
+    size_t size() const { return n_; }
+    const DeviceArray& mem() const { return mem_; }
+    void write(const std::vector<float>& host) { mem_.write(host.data(), n_ * sizeof(float)); }
+    void read(std::vector<float>& host) { host.resize(n_); mem_.read(host.data(), n_ * sizeof(float)); }
+
+    template <typename E>
+    DArray& operator=(const Expr<E>& e) {
+        ExprArgs args;
+        std::string code;
+        e.self().gen(code, args);
+        ctx_->evaluate(*this, code, args);
+        return *this;
+    }
+    // device copy, also a (trivial) fused kernel
+    DArray& operator=(const DArray& other) {
+        return *this = static_cast<const Expr<DArray>&>(other);
+    }
+
+    void gen(std::string& code, ExprArgs& args) const {
+        code += "v" + std::to_string(args.arrayIndex(this));
+    }
+
+private:
+    ExprContext* ctx_;
+    size_t n_;
+    DeviceArray mem_;
+};
+
+struct Scalar : public Expr<Scalar> {
+    float value;
+    explicit Scalar(float v) : value(v) {}
+    void gen(std::string& code, ExprArgs& args) const {
+        code += "s" + std::to_string(args.scalars.size());
+        args.scalars.push_back(value);
+    }
+};
+
+// arrays are held by reference, inner nodes and scalars by value
+template <typename T> struct NodeRef { typedef const T type; };
+template <> struct NodeRef<DArray> { typedef const DArray& type; };
+
+template <char Op, typename L, typename R>
+struct BinOp : public Expr<BinOp<Op, L, R>> {
+    typename NodeRef<L>::type l;
+    typename NodeRef<R>::type r;
+    BinOp(const L& l_, const R& r_) : l(l_), r(r_) {}
+    void gen(std::string& code, ExprArgs& args) const {
+        code += "(";
+        l.gen(code, args);
+        code += std::string(" ") + Op + " ";
+        r.gen(code, args);
+        code += ")";
+    }
+};
+
+#define EXPR_BINARY_OP(op, ch)                                                         \
+    template <typename L, typename R>                                                  \
+    BinOp<ch, L, R> operator op(const Expr<L>& l, const Expr<R>& r) {                  \
+        return BinOp<ch, L, R>(l.self(), r.self());                                    \
+    }                                                                                  \
+    template <typename L>                                                              \
+    BinOp<ch, L, Scalar> operator op(const Expr<L>& l, float r) {                      \
+        return BinOp<ch, L, Scalar>(l.self(), Scalar(r));                              \
+    }                                                                                  \
+    template <typename R>                                                              \
+    BinOp<ch, Scalar, R> operator op(float l, const Expr<R>& r) {                      \
+        return BinOp<ch, Scalar, R>(Scalar(l), r.self());                              \
+    }
+
+EXPR_BINARY_OP(+, '+')
+EXPR_BINARY_OP(-, '-')
+EXPR_BINARY_OP(*, '*')
+EXPR_BINARY_OP(/, '/')
+#undef EXPR_BINARY_OP
+
+inline void ExprContext::evaluate(const DArray& dst, const std::string& code, const ExprArgs& args) {
+    for (const DArray* a : args.arrays)
+        if (a->size() != dst.size())
+            throw std::runtime_error("expr: array sizes differ");
+
+    cl::Kernel& kernel = kernelFor(code, args.arrays.size(), args.scalars.size());
+    cl_uint idx = 0;
+    dst.mem().setArg(kernel, idx++);
+    for (const DArray* a : args.arrays)
+        a->mem().setArg(kernel, idx++);
+    for (float s : args.scalars)
+        kernel.setArg(idx++, s);
+    kernel.setArg(idx++, (cl_uint)dst.size());
+    size_t global = (dst.size() + 255) / 256 * 256;
+    env_.queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(std::max<size_t>(global, 256)), cl::NullRange);
+    launches_++;
+}
+
+} // namespace expr
@@ -0,0 +1,378 @@
+#pragma once
+
+// Single-precision GEMM, C = A * B, row-major, any M / N / K.
+//
+//   GemmNaive    one C element per work-item, straight from global memory
+//   Gemm         TSM x TSN output tile per work-group, TSK-deep slices of A
+//                and B staged in local memory, each work-item accumulating a
+//                WPTM x WPTN register block. Tile sizes are compile-time
+//                (-D) so the inner loops fully unroll.
+//   autotuneGemm times the candidate configs that fit the device once and
+//                caches the winner per device name in a small text file.
+//   BatchedGemm  many small same-shape GEMMs in one launch; each matrix is
+//                staged in local memory, tiny ones are packed several per
+//                work-group, ones with more elements than a work-group has
+//                work-items are computed a few elements per work-item.
+
+#include "ocl_env.h"
+
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <tuple>
+
+static const char* gemmSource = R"(
+    __kernel void gemmNaive(int M, int N, int K, __global const float* A, __global const float* B, __global float* C)
+    {
+        int j = get_global_id(0);
+        int i = get_global_id(1);
+        if (i >= M || j >= N)
+            return;
+        float acc = 0.f;
+        for (int k = 0; k < K; ++k)
+            acc += A[i * K + k] * B[k * N + j];
+        C[i * N + j] = acc;
+    }
+
+    #ifdef TSM
+    #define RTSM (TSM / WPTM)
+    #define RTSN (TSN / WPTN)
+
+    __kernel void gemmTiled(int M, int N, int K, __global const float* A, __global const float* B, __global float* C)
+    {
+        __local float Asub[TSK][TSM];
+        __local float Bsub[TSK][TSN];
+
+        int tidn = get_local_id(0);
+        int tidm = get_local_id(1);
+        int tid = tidm * RTSN + tidn;
+        int offsetM = TSM * get_group_id(1);
+        int offsetN = TSN * get_group_id(0);
+
+        float acc[WPTM][WPTN];
+        for (int wm = 0; wm < WPTM; ++wm)
+            for (int wn = 0; wn < WPTN; ++wn)
+                acc[wm][wn] = 0.f;
+        float Breg[WPTN];
+
+        for (int t = 0; t < K; t += TSK) {
+            for (int l = tid; l < TSM * TSK; l += RTSM * RTSN) {
+                int row = l / TSK, col = l % TSK;
+                int gr = offsetM + row, gc = t + col;
+                Asub[col][row] = (gr < M && gc < K) ? A[gr * K + gc] : 0.f;
+            }
+            for (int l = tid; l < TSK * TSN; l += RTSM * RTSN) {
+                int row = l / TSN, col = l % TSN;
+                int gr = t + row, gc = offsetN + col;
+                Bsub[row][col] = (gr < K && gc < N) ? B[gr * N + gc] : 0.f;
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+
+            #pragma unroll
+            for (int k = 0; k < TSK; ++k) {
+                #pragma unroll
+                for (int wn = 0; wn < WPTN; ++wn)
+                    Breg[wn] = Bsub[k][tidn + wn * RTSN];
+                #pragma unroll
+                for (int wm = 0; wm < WPTM; ++wm) {
+                    float a = Asub[k][tidm + wm * RTSM];
+                    #pragma unroll
+                    for (int wn = 0; wn < WPTN; ++wn)
+                        acc[wm][wn] += a * Breg[wn];
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        for (int wm = 0; wm < WPTM; ++wm) {
+            int gr = offsetM + tidm + wm * RTSM;
+            for (int wn = 0; wn < WPTN; ++wn) {
+                int gc = offsetN + tidn + wn * RTSN;
+                if (gr < M && gc < N)
+                    C[gr * N + gc] = acc[wm][wn];
+            }
+        }
+    }
+    #endif
+
+    #ifdef BM
+    // MPG matrices per work-group, IPM work-items per matrix; a work-item
+    // computes every IPM-th C element of its matrix
+    __kernel void gemmBatched(__global const float* A, __global const float* B, __global float* C, int batch)
+    {
+        __local float As[MPG][BM * BK];
+        __local float Bs[MPG][BK * BN];
+
+        int lid = get_local_id(0);
+        int m = lid / IPM;
+        int e0 = lid % IPM;
+        long b = (long)get_group_id(0) * MPG + m;
+        bool active = b < batch;
+
+        for (int l = e0; l < BM * BK; l += IPM)
+            As[m][l] = active ? A[b * (BM * BK) + l] : 0.f;
+        for (int l = e0; l < BK * BN; l += IPM)
+            Bs[m][l] = active ? B[b * (BK * BN) + l] : 0.f;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (active) {
+            for (int e = e0; e < BM * BN; e += IPM) {
+                int i = e / BN;
+                int j = e % BN;
+                float acc = 0.f;
+                #pragma unroll
+                for (int k = 0; k < BK; ++k)
+                    acc += As[m][i * BK + k] * Bs[m][k * BN + j];
+                C[b * (BM * BN) + e] = acc;
+            }
+        }
+    }
+    #endif
+)";
+
+struct GemmConfig {
+    int tsm = 64, tsn = 64, tsk = 16, wptm = 4, wptn = 4;
+
+    std::string str() const {
+        std::ostringstream s;
+        s << tsm << " " << tsn << " " << tsk << " " << wptm << " " << wptn;
+        return s.str();
+    }
+    bool parse(const std::string& line) {
+        std::istringstream s(line);
+        return (bool)(s >> tsm >> tsn >> tsk >> wptm >> wptn);
+    }
+    std::string options() const {
+        return "-D TSM=" + std::to_string(tsm) + " -D TSN=" + std::to_string(tsn) + " -D TSK=" + std::to_string(tsk) +
+               " -D WPTM=" + std::to_string(wptm) + " -D WPTN=" + std::to_string(wptn);
+    }
+    size_t localX() const { return tsn / wptn; }
+    size_t localY() const { return tsm / wptm; }
+    bool fits(OclEnv& env) const {
+        size_t local = (size_t)tsk * (tsm + tsn) * sizeof(float);
+        return tsm % wptm == 0 && tsn % wptn == 0 &&
+               localX() * localY() <= env.device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>() &&
+               local <= env.device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    }
+};
+
+class GemmNaive {
+public:
+    explicit GemmNaive(OclEnv& env) : env_(env) {
+        program_ = buildProgram(env, gemmSource);
+        kernel_ = cl::Kernel(program_, "gemmNaive");
+    }
+
+    void run(const DeviceArray& A, const DeviceArray& B, DeviceArray& C, int M, int N, int K) {
+        kernel_.setArg(0, M);
+        kernel_.setArg(1, N);
+        kernel_.setArg(2, K);
+        A.setArg(kernel_, 3);
+        B.setArg(kernel_, 4);
+        C.setArg(kernel_, 5);
+        cl::NDRange global((N + 15) / 16 * 16, (M + 15) / 16 * 16);
+        cl_int err = env_.queue.enqueueNDRangeKernel(kernel_, cl::NullRange, global, cl::NullRange);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("gemmNaive launch failed: " + std::to_string(err));
+    }
+
+private:
+    OclEnv& env_;
+    cl::Program program_;
+    cl::Kernel kernel_;
+};
+
+class Gemm {
+public:
+    Gemm(OclEnv& env, const GemmConfig& cfg) : env_(env), cfg_(cfg) {
+        if (!cfg.fits(env))
+            throw std::runtime_error("Gemm: config " + cfg.str() + " does not fit the device");
+        program_ = buildProgram(env, gemmSource, cfg.options());
+        kernel_ = cl::Kernel(program_, "gemmTiled");
+        // the compiler may lower the limit when the register block is large
+        if (cfg.localX() * cfg.localY() > kernel_.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(env.device))
+            throw std::runtime_error("Gemm: config " + cfg.str() + " exceeds the kernel work-group limit");
+    }
+
+    const GemmConfig& config() const { return cfg_; }
+
+    void run(const DeviceArray& A, const DeviceArray& B, DeviceArray& C, int M, int N, int K) {
+        kernel_.setArg(0, M);
+        kernel_.setArg(1, N);
+        kernel_.setArg(2, K);
+        A.setArg(kernel_, 3);
+        B.setArg(kernel_, 4);
+        C.setArg(kernel_, 5);
+        size_t groupsX = (N + cfg_.tsn - 1) / cfg_.tsn;
+        size_t groupsY = (M + cfg_.tsm - 1) / cfg_.tsm;
+        cl::NDRange global(groupsX * cfg_.localX(), groupsY * cfg_.localY());
+        cl_int err =
+            env_.queue.enqueueNDRangeKernel(kernel_, cl::NullRange, global, cl::NDRange(cfg_.localX(), cfg_.localY()));
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("gemmTiled " + cfg_.str() + " launch failed: " + std::to_string(err));
+    }
+
+private:
+    OclEnv& env_;
+    GemmConfig cfg_;
+    cl::Program program_;
+    cl::Kernel kernel_;
+};
+
+static std::vector<GemmConfig> gemmCandidates() {
+    std::vector<GemmConfig> c;
+    for (int ts : {32, 64, 128})
+        for (int tsk : {8, 16, 32})
+            for (int wpt : {2, 4, 8}) {
+                if (ts / wpt < 4 || ts / wpt > 32)
+                    continue;
+                GemmConfig g;
+                g.tsm = g.tsn = ts;
+                g.tsk = tsk;
+                g.wptm = g.wptn = wpt;
+                c.push_back(g);
+            }
+    return c;
+}
+
+// Times every candidate on a size x size x size problem, unless the cache
+// file already has an entry for this device. Cache lines: "<device>|<config>".
+// A candidate that fails to build, exceeds the kernel's work-group limit or
+// fails to launch is skipped. If none runs, the default config is returned
+// and nothing is cached.
+static GemmConfig autotuneGemm(OclEnv& env, const std::string& cachePath = "gemm-tune.cache", int size = 1024,
+                               bool verbose = true) {
+    std::string device = env.device.getInfo<CL_DEVICE_NAME>();
+    {
+        std::ifstream in(cachePath);
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t bar = line.rfind('|');
+            GemmConfig cfg;
+            if (bar != std::string::npos && line.substr(0, bar) == device && cfg.parse(line.substr(bar + 1)) && cfg.fits(env)) {
+                if (verbose)
+                    std::cout << "gemm config from " << cachePath << ": " << cfg.str() << std::endl;
+                return cfg;
+            }
+        }
+    }
+
+    size_t bytes = (size_t)size * size * sizeof(float);
+    std::vector<float> host((size_t)size * size, 1.f);
+    DeviceArray A(env, MemKind::Buffer, bytes), B(env, MemKind::Buffer, bytes), C(env, MemKind::Buffer, bytes);
+    A.write(host);
+    B.write(host);
+
+    GemmConfig best;
+    double bestTime = 1e30;
+    bool tuned = false;
+    for (const GemmConfig& cfg : gemmCandidates()) {
+        if (!cfg.fits(env))
+            continue;
+        try {
+            Gemm gemm(env, cfg);
+            gemm.run(A, B, C, size, size, size);   // warm up
+            env.queue.finish();
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (int r = 0; r < 3; ++r)
+                gemm.run(A, B, C, size, size, size);
+            env.queue.finish();
+            double t = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count() / 3;
+            if (verbose)
+                printf("  tune %-16s %8.1f GFLOP/s\n", cfg.str().c_str(), 2.0 * size * size * size / t / 1e9);
+            if (t < bestTime) {
+                bestTime = t;
+                best = cfg;
+                tuned = true;
+            }
+        } catch (const std::exception& ex) {
+            // register pressure or a driver limit: not a candidate on this device
+            if (verbose)
+                std::cout << "  tune " << cfg.str() << " skipped: " << ex.what() << std::endl;
+        }
+    }
+
+    if (!tuned) {
+        if (verbose)
+            std::cout << "gemm config: no candidate ran, using the default " << best.str() << std::endl;
+        return best;
+    }
+    std::ofstream out(cachePath, std::ios::app);
+    out << device << "|" << best.str() << "\n";
+    if (verbose)
+        std::cout << "gemm config tuned: " << best.str() << std::endl;
+    return best;
+}
+
+class BatchedGemm {
+public:
+    explicit BatchedGemm(OclEnv& env) : env_(env) {
+        maxWg_ = env.device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    }
+
+    // A: batch x M x K, B: batch x K x N, C: batch x M x N, densely packed
+    void run(const DeviceArray& A, const DeviceArray& B, DeviceArray& C, int batch, int M, int N, int K) {
+        Shape& s = shape(M, N, K);
+        A.setArg(s.kernel, 0);
+        B.setArg(s.kernel, 1);
+        C.setArg(s.kernel, 2);
+        s.kernel.setArg(3, batch);
+        size_t groups = (batch + s.mpg - 1) / s.mpg;
+        size_t local = (size_t)s.mpg * s.ipm;
+        cl_int err =
+            env_.queue.enqueueNDRangeKernel(s.kernel, cl::NullRange, cl::NDRange(groups * local), cl::NDRange(local));
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("gemmBatched launch failed: " + std::to_string(err));
+    }
+
+    // work-items per matrix for a shape, after run() has built it
+    int itemsPerMatrix(int M, int N, int K) { return shape(M, N, K).ipm; }
+
+private:
+    struct Shape {
+        int mpg;   // matrices per work-group
+        int ipm;   // work-items per matrix
+        cl::Program program;
+        cl::Kernel kernel;
+    };
+
+    // one program per matrix shape, built on first use
+    Shape& shape(int M, int N, int K) {
+        auto key = std::make_tuple(M, N, K);
+        auto it = shapes_.find(key);
+        if (it != shapes_.end())
+            return it->second;
+        size_t localBytes = (size_t)(M * K + K * N) * sizeof(float);
+        size_t localMem = env_.device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+        if (localBytes > localMem)
+            throw std::runtime_error("BatchedGemm: matrices do not fit in local memory, use Gemm");
+        Shape s;
+        int elems = M * N;
+        size_t limit = maxWg_;
+        for (;;) {
+            // one work-item per element up to the limit; pack tiny matrices
+            // until a work-group has ~64 work-items
+            s.ipm = (int)std::min<size_t>(elems, limit);
+            s.mpg = std::max(1, std::min((int)(limit / s.ipm), 64 / s.ipm));
+            s.mpg = (int)std::max<size_t>(1, std::min<size_t>(s.mpg, localMem / localBytes));
+            std::string opts = "-D BM=" + std::to_string(M) + " -D BN=" + std::to_string(N) +
+                               " -D BK=" + std::to_string(K) + " -D MPG=" + std::to_string(s.mpg) +
+                               " -D IPM=" + std::to_string(s.ipm);
+            s.program = buildProgram(env_, gemmSource, opts);
+            s.kernel = cl::Kernel(s.program, "gemmBatched");
+            // the compiler may allow fewer work-items than the device maximum
+            size_t kernelWg = s.kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(env_.device);
+            if ((size_t)s.mpg * s.ipm <= kernelWg)
+                break;
+            if (kernelWg == 0 || kernelWg >= limit)
+                throw std::runtime_error("BatchedGemm: no work-group size fits the kernel");
+            limit = kernelWg;
+        }
+        return shapes_.emplace(key, s).first->second;
+    }
+
+    OclEnv& env_;
+    size_t maxWg_;
+    std::map<std::tuple<int, int, int>, Shape> shapes_;
+};
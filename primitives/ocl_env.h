@@ -0,0 +1,213 @@
+#pragma once
+
+// Shared setup for the primitive kernels: platform/device/queue, program
+// build with log, and DeviceArray, one allocation that can live in a
+// cl::Buffer, coarse-grain SVM or Intel USM device memory. USM entry points
+// are resolved at runtime (usm_api.h), so no Intel headers are needed.
+
+#include <CL/cl2.hpp>
+
+#include "usm_api.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static void printDeviceInfo(cl::Device& device) {
+    std::cout << "### Device ### "  << std::endl;
+
+    std::cout << "Device Name: " << device.getInfo<CL_DEVICE_NAME>() << std::endl;
+    std::cout << "Device Vendor: " << device.getInfo<CL_DEVICE_VENDOR>() << std::endl;
+    std::cout << "Device Version: " << device.getInfo<CL_DEVICE_VERSION>() << std::endl;
+    std::cout << "Driver Version: " << device.getInfo<CL_DRIVER_VERSION>() << std::endl;
+    std::cout << "OpenCL C Version: " << device.getInfo<CL_DEVICE_OPENCL_C_VERSION>() << std::endl;
+
+    cl_ulong globalMemSize = device.getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
+    std::cout << "Global Memory Size: " << globalMemSize / (1024 * 1024) << " MB" << std::endl;
+
+    cl_ulong localMemSize = device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    std::cout << "Local Memory Size: " << localMemSize / 1024 << " KB" << std::endl;
+
+    cl_uint computeUnits = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    std::cout << "Compute Units: " << computeUnits << std::endl;
+
+    size_t workGroupSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    std::cout << "Max Work Group Size: " << workGroupSize << std::endl;
+    std::cout << "### ### "  << std::endl;
+}
+
+struct OclEnv {
+    cl::Platform platform;
+    cl::Device device;
+    cl::Context context;
+    cl::CommandQueue queue;
+    cl_device_svm_capabilities svmCaps = 0;
+    bool subgroups = false;   // cl_khr_subgroups or cl_intel_subgroups
+
+    UsmApi usmApi;   // null entry points without cl_intel_unified_shared_memory
+
+    bool svm() const { return (svmCaps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER) != 0; }
+    bool usm() const { return usmApi.available(); }
+
+    static OclEnv create(bool verbose = true, cl_command_queue_properties props = 0) {
+        OclEnv env;
+        std::vector<cl::Platform> platforms;
+        cl::Platform::get(&platforms);
+        if (platforms.empty()) {
+            throw std::runtime_error("No OpenCL platforms found");
+        }
+        env.platform = platforms[0];
+
+        std::vector<cl::Device> devices;
+        env.platform.getDevices(CL_DEVICE_TYPE_GPU, &devices);
+        if (devices.empty()) {
+            throw std::runtime_error("No OpenCL devices found");
+        }
+        env.device = devices[0];
+        if (verbose)
+            printDeviceInfo(env.device);
+
+        env.context = cl::Context(env.device);
+        env.queue = cl::CommandQueue(env.context, env.device, props);
+        clGetDeviceInfo(env.device(), CL_DEVICE_SVM_CAPABILITIES, sizeof(env.svmCaps), &env.svmCaps, nullptr);
+        std::string ext = env.device.getInfo<CL_DEVICE_EXTENSIONS>();
+        env.subgroups = ext.find("cl_khr_subgroups") != std::string::npos || ext.find("cl_intel_subgroups") != std::string::npos;
+
+        env.usmApi = UsmApi::load(env.platform);
+        return env;
+    }
+};
+
+// build with log on failure
+static cl::Program buildProgram(OclEnv& env, const std::string& source, const std::string& opts = "") {
+    cl::Program program(env.context, source);
+    cl_int err = program.build({env.device}, opts.c_str());
+    if (err != CL_SUCCESS) {
+        std::cerr << "Build log:\n" << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(env.device) << std::endl;
+        throw std::runtime_error("Program build failed: " + std::to_string(err));
+    }
+    return program;
+}
+
+enum class MemKind { Buffer, Svm, Usm };
+
+static const char* memKindName(MemKind kind) {
+    switch (kind) {
+    case MemKind::Buffer: return "buffer";
+    case MemKind::Svm: return "svm";
+    default: return "usm";
+    }
+}
+
+static bool memKindSupported(const OclEnv& env, MemKind kind) {
+    if (kind == MemKind::Svm) return env.svm();
+    if (kind == MemKind::Usm) return env.usm();
+    return true;
+}
+
+// one device allocation of `bytes`, whatever its kind; move-only
+class DeviceArray {
+public:
+    DeviceArray() {}
+    DeviceArray(OclEnv& env, MemKind kind, size_t bytes) : env_(&env), kind_(kind), bytes_(bytes) {
+        if (kind == MemKind::Buffer) {
+            buffer_ = cl::Buffer(env.context, CL_MEM_READ_WRITE, bytes);
+        } else if (kind == MemKind::Svm) {
+            ptr_ = clSVMAlloc(env.context(), CL_MEM_READ_WRITE, bytes, 0);
+            if (!ptr_)
+                throw std::runtime_error("clSVMAlloc failed");
+        } else {
+            ptr_ = env.usmApi.alloc(UsmKind::Device, env.context, env.device, bytes);
+        }
+    }
+    DeviceArray(const DeviceArray&) = delete;
+    DeviceArray& operator=(const DeviceArray&) = delete;
+    DeviceArray(DeviceArray&& o) noexcept { *this = std::move(o); }
+    DeviceArray& operator=(DeviceArray&& o) noexcept {
+        std::swap(env_, o.env_);
+        std::swap(kind_, o.kind_);
+        std::swap(bytes_, o.bytes_);
+        std::swap(buffer_, o.buffer_);
+        std::swap(ptr_, o.ptr_);
+        return *this;
+    }
+    ~DeviceArray() {
+        if (!ptr_) return;
+        if (kind_ == MemKind::Svm) clSVMFree(env_->context(), ptr_);
+        else env_->usmApi.memBlockingFree(env_->context(), ptr_);
+    }
+
+    MemKind kind() const { return kind_; }
+    size_t bytes() const { return bytes_; }
+
+    void setArg(cl::Kernel& kernel, cl_uint index) const {
+        cl_int err = CL_SUCCESS;
+        cl_mem mem = buffer_();
+        if (kind_ == MemKind::Buffer) err = clSetKernelArg(kernel(), index, sizeof(cl_mem), &mem);
+        else if (kind_ == MemKind::Svm) err = clSetKernelArgSVMPointer(kernel(), index, ptr_);
+        else err = env_->usmApi.setKernelArgMemPointer(kernel(), index, ptr_);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("DeviceArray::setArg failed: " + std::to_string(err));
+    }
+
+    void write(const void* host, size_t bytes, size_t offset = 0) {
+        if (kind_ == MemKind::Buffer)
+            env_->queue.enqueueWriteBuffer(buffer_, CL_TRUE, offset, bytes, host);
+        else if (kind_ == MemKind::Svm)
+            clEnqueueSVMMemcpy(env_->queue(), CL_TRUE, (char*)ptr_ + offset, host, bytes, 0, nullptr, nullptr);
+        else
+            env_->usmApi.memcpy(env_->queue, (char*)ptr_ + offset, host, bytes);
+    }
+
+    void read(void* host, size_t bytes, size_t offset = 0) {
+        if (kind_ == MemKind::Buffer)
+            env_->queue.enqueueReadBuffer(buffer_, CL_TRUE, offset, bytes, host);
+        else if (kind_ == MemKind::Svm)
+            clEnqueueSVMMemcpy(env_->queue(), CL_TRUE, host, (char*)ptr_ + offset, bytes, 0, nullptr, nullptr);
+        else
+            env_->usmApi.memcpy(env_->queue, host, (char*)ptr_ + offset, bytes);
+    }
+
+    template <typename T>
+    void write(const std::vector<T>& host) { write(host.data(), host.size() * sizeof(T)); }
+    template <typename T>
+    void read(std::vector<T>& host) { read(host.data(), host.size() * sizeof(T)); }
+
+private:
+    OclEnv* env_ = nullptr;
+    MemKind kind_ = MemKind::Buffer;
+    size_t bytes_ = 0;
+    cl::Buffer buffer_;
+    void* ptr_ = nullptr;
+};
+
+// median of a few timings, in seconds
+static double medianOf(std::vector<double> v) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+// median seconds of `runs` calls of body(), each followed by queue.finish();
+// warmUp adds one untimed call first (kernel builds, first-touch)
+template <typename F>
+static double timeRuns(OclEnv& env, int runs, F&& body, bool warmUp = false) {
+    if (warmUp) {
+        body();
+        env.queue.finish();
+    }
+    std::vector<double> t;
+    for (int r = 0; r < runs; ++r) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        body();
+        env.queue.finish();
+        t.push_back(std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count());
+    }
+    return medianOf(t);
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+// LSD radix sort for 32- or 64-bit unsigned keys, optionally carrying a uint
+// value per key. 4 bits per pass, so 8 or 16 passes, each of them
+//   radixHistogram  per-block digit counts, stored digit-major
+//   Scanner         exclusive scan of the counts -> global output offsets
+//   radixScatter    stable in-block sort by the digit (four 1-bit splits in
+//                   local memory), then a coalesced-ish scatter
+// A block is one work-group of WG keys. The pass count is even, so the result
+// always ends in the caller's arrays; the ping-pong copies are allocated with
+// the same MemKind as the input and kept for later calls.
+
+#include "ocl_env.h"
+#include "scan.h"
+
+static const char* radixSortSource = R"(
+    #define RADIX_BITS 4
+    #define RADIX (1 << RADIX_BITS)
+    #define DIGIT(k, shift) ((uint)((k) >> (shift)) & (RADIX - 1))
+
+    __kernel void radixHistogram(__global const KEY* keys, uint n, uint shift, uint blocks, __global uint* hist)
+    {
+        __local uint lh[RADIX];
+        int lid = get_local_id(0);
+        if (lid < RADIX)
+            lh[lid] = 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        uint i = get_global_id(0);
+        if (i < n)
+            atomic_inc(&lh[DIGIT(keys[i], shift)]);
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (lid < RADIX)
+            hist[lid * blocks + get_group_id(0)] = lh[lid];
+    }
+
+    uint groupExclusiveScan(uint x, __local uint* s, uint* total)
+    {
+        int lid = get_local_id(0);
+        s[lid] = x;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (int off = 1; off < WG; off <<= 1) {
+            uint t = lid >= off ? s[lid - off] : 0;
+            barrier(CLK_LOCAL_MEM_FENCE);
+            s[lid] += t;
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+        *total = s[WG - 1];
+        uint r = s[lid] - x;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        return r;
+    }
+
+    __kernel void radixScatter(__global const KEY* keys_in, __global KEY* keys_out,
+    #ifdef HAS_VALUES
+                               __global const uint* vals_in, __global uint* vals_out,
+    #endif
+                               uint n, uint shift, uint blocks, __global const uint* offsets)
+    {
+        __local KEY lk[WG];
+        __local uint lv[WG];
+        __local uint lvalid[WG];
+        __local uint ls[WG];
+        __local uint start[RADIX];
+
+        int lid = get_local_id(0);
+        uint i = get_global_id(0);
+        uint valid = i < n;
+        // padding sorts last: all ones, and it already sits at the end of the block
+        KEY k = valid ? keys_in[i] : (KEY)(-1);
+    #ifdef HAS_VALUES
+        uint v = valid ? vals_in[i] : 0;
+    #else
+        uint v = 0;
+    #endif
+
+        for (int bit = 0; bit < RADIX_BITS; ++bit) {
+            uint b = (uint)(k >> (shift + bit)) & 1;
+            uint zeros;
+            uint zerosBefore = groupExclusiveScan(1 - b, ls, &zeros);
+            uint dst = b ? zeros + (lid - zerosBefore) : zerosBefore;
+            lk[dst] = k;
+            lv[dst] = v;
+            lvalid[dst] = valid;
+            barrier(CLK_LOCAL_MEM_FENCE);
+            k = lk[lid];
+            v = lv[lid];
+            valid = lvalid[lid];
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        uint d = DIGIT(k, shift);
+        if (lid == 0 || d != DIGIT(lk[lid - 1], shift))
+            start[d] = lid;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (valid) {
+            uint pos = offsets[d * blocks + get_group_id(0)] + lid - start[d];
+            keys_out[pos] = k;
+    #ifdef HAS_VALUES
+            vals_out[pos] = v;
+    #endif
+        }
+    }
+)";
+
+class RadixSorter {
+public:
+    // keyBits: 32 (uint keys) or 64 (ulong keys)
+    RadixSorter(OclEnv& env, Scanner& scanner, int keyBits = 32, bool withValues = false)
+        : env_(env), scanner_(scanner), keyBits_(keyBits), withValues_(withValues) {
+        if (keyBits != 32 && keyBits != 64)
+            throw std::runtime_error("RadixSorter: keys must be 32 or 64 bits");
+        wg_ = (int)std::min<size_t>(256, env.device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+        std::string opts = "-D WG=" + std::to_string(wg_) + (keyBits == 64 ? " -D KEY=ulong" : " -D KEY=uint");
+        if (withValues)
+            opts += " -D HAS_VALUES";
+        program_ = buildProgram(env, radixSortSource, opts);
+        histKernel_ = cl::Kernel(program_, "radixHistogram");
+        scatterKernel_ = cl::Kernel(program_, "radixScatter");
+    }
+
+    // stable, ascending, in place
+    void sort(DeviceArray& keys, size_t n, DeviceArray* values = nullptr) {
+        if (n <= 1) return;
+        if (n > 0xffffffffu)
+            throw std::runtime_error("RadixSorter: more than 2^32 elements");
+        if (withValues_ != (values != nullptr))
+            throw std::runtime_error("RadixSorter: values given to a keys-only sorter or missing");
+
+        size_t keyBytes = n * (keyBits_ / 8);
+        if (tmpKeys_.bytes() < keyBytes || tmpKeys_.kind() != keys.kind())
+            tmpKeys_ = DeviceArray(env_, keys.kind(), keyBytes);
+        if (values && (tmpVals_.bytes() < n * sizeof(cl_uint) || tmpVals_.kind() != values->kind()))
+            tmpVals_ = DeviceArray(env_, values->kind(), n * sizeof(cl_uint));
+        size_t blocks = (n + wg_ - 1) / wg_;
+        size_t histBytes = 16 * blocks * sizeof(cl_uint);
+        if (hist_.bytes() < histBytes)
+            hist_ = DeviceArray(env_, MemKind::Buffer, histBytes);
+
+        DeviceArray* srcK = &keys;
+        DeviceArray* dstK = &tmpKeys_;
+        DeviceArray* srcV = values;
+        DeviceArray* dstV = &tmpVals_;
+        cl::NDRange global(blocks * wg_), local(wg_);
+        for (int shift = 0; shift < keyBits_; shift += 4) {
+            srcK->setArg(histKernel_, 0);
+            histKernel_.setArg(1, (cl_uint)n);
+            histKernel_.setArg(2, (cl_uint)shift);
+            histKernel_.setArg(3, (cl_uint)blocks);
+            hist_.setArg(histKernel_, 4);
+            env_.queue.enqueueNDRangeKernel(histKernel_, cl::NullRange, global, local);
+
+            scanner_.exclusive(hist_, hist_, 16 * blocks);
+
+            cl_uint arg = 0;
+            srcK->setArg(scatterKernel_, arg++);
+            dstK->setArg(scatterKernel_, arg++);
+            if (values) {
+                srcV->setArg(scatterKernel_, arg++);
+                dstV->setArg(scatterKernel_, arg++);
+            }
+            scatterKernel_.setArg(arg++, (cl_uint)n);
+            scatterKernel_.setArg(arg++, (cl_uint)shift);
+            scatterKernel_.setArg(arg++, (cl_uint)blocks);
+            hist_.setArg(scatterKernel_, arg++);
+            env_.queue.enqueueNDRangeKernel(scatterKernel_, cl::NullRange, global, local);
+
+            std::swap(srcK, dstK);
+            std::swap(srcV, dstV);
+        }
+    }
+
+private:
+    OclEnv& env_;
+    Scanner& scanner_;
+    int keyBits_;
+    bool withValues_;
+    int wg_ = 256;
+    cl::Program program_;
+    cl::Kernel histKernel_, scatterKernel_;
+    DeviceArray tmpKeys_, tmpVals_, hist_;
+};
@@ -0,0 +1,325 @@
+#pragma once
+
+// Two-stage GPU reductions: sum, min/max with index, argmin.
+//
+// Stage 1 runs a fixed number of work-groups that grid-stride over the input,
+// reduce in registers, then across the work-group (sub_group_reduce_* when the
+// device has subgroups, a local-memory tree otherwise) and write one partial
+// per group. Stage 2 is a single work-group over the partials, so only a few
+// bytes are read back. Inputs can be any DeviceArray (cl::Buffer, SVM, USM)
+// holding float, int or half. half is read with vload_half and reduced in
+// float, so cl_khr_fp16 is not required. Ties resolve to the smallest index,
+// as the host loop would.
+
+#include "ocl_env.h"
+
+#include <cmath>
+#include <cstdint>
+
+enum class ElemType { Float = 0, Int = 1, Half = 2 };
+
+static const char* elemTypeName(ElemType t) {
+    switch (t) {
+    case ElemType::Float: return "float";
+    case ElemType::Int: return "int";
+    default: return "half";
+    }
+}
+
+static size_t elemSize(ElemType t) {
+    return t == ElemType::Half ? 2 : 4;
+}
+
+static const char* reduceSource = R"(
+    #if ELEM == 0
+        typedef float T;
+        typedef float SUM;
+        typedef float VAL;
+        #define LOAD(p, i) (p)[i]
+        #define VAL_MAX INFINITY
+    #elif ELEM == 1
+        typedef int T;
+        typedef long SUM;
+        typedef int VAL;
+        #define LOAD(p, i) (p)[i]
+        #define VAL_MAX INT_MAX
+    #else
+        typedef half T;
+        typedef float SUM;
+        typedef float VAL;
+        #define LOAD(p, i) vload_half(i, p)
+        #define VAL_MAX INFINITY
+    #endif
+    #define NO_INDEX ((ulong)-1)
+
+    #ifdef USE_SUBGROUPS
+    #pragma OPENCL EXTENSION cl_khr_subgroups : enable
+    #endif
+
+    SUM groupSum(SUM v, __local SUM* scratch)
+    {
+        int lid = get_local_id(0);
+    #ifdef USE_SUBGROUPS
+        v = sub_group_reduce_add(v);
+        if (get_sub_group_local_id() == 0)
+            scratch[get_sub_group_id()] = v;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (lid == 0) {
+            for (uint s = 1; s < get_num_sub_groups(); ++s)
+                v += scratch[s];
+            scratch[0] = v;
+        }
+    #else
+        scratch[lid] = v;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (int s = WG / 2; s > 0; s >>= 1) {
+            if (lid < s)
+                scratch[lid] += scratch[lid + s];
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    #endif
+        barrier(CLK_LOCAL_MEM_FENCE);
+        return scratch[0];
+    }
+
+    // smaller value wins, equal values go to the smaller index
+    #define BETTER(v, i, bv, bi, LESS) ((i) != NO_INDEX && ((bi) == NO_INDEX || LESS((v), (bv)) || ((v) == (bv) && (i) < (bi))))
+    #define LT(a, b) ((a) < (b))
+    #define GT(a, b) ((a) > (b))
+
+    // folds (vmin, imin, vmax, imax) over the work-group, result in slot 0
+    void groupMinMax(VAL* vmin, ulong* imin, VAL* vmax, ulong* imax,
+                     __local VAL* lmin, __local ulong* jmin, __local VAL* lmax, __local ulong* jmax)
+    {
+        int lid = get_local_id(0);
+    #ifdef USE_SUBGROUPS
+        VAL smin = sub_group_reduce_min(*vmin);
+        VAL smax = sub_group_reduce_max(*vmax);
+        ulong cmin = sub_group_reduce_min(*vmin == smin ? *imin : NO_INDEX);
+        ulong cmax = sub_group_reduce_min(*vmax == smax ? *imax : NO_INDEX);
+        if (get_sub_group_local_id() == 0) {
+            uint s = get_sub_group_id();
+            lmin[s] = smin; jmin[s] = cmin;
+            lmax[s] = smax; jmax[s] = cmax;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (lid == 0) {
+            for (uint s = 1; s < get_num_sub_groups(); ++s) {
+                if (BETTER(lmin[s], jmin[s], lmin[0], jmin[0], LT)) { lmin[0] = lmin[s]; jmin[0] = jmin[s]; }
+                if (BETTER(lmax[s], jmax[s], lmax[0], jmax[0], GT)) { lmax[0] = lmax[s]; jmax[0] = jmax[s]; }
+            }
+        }
+    #else
+        lmin[lid] = *vmin; jmin[lid] = *imin;
+        lmax[lid] = *vmax; jmax[lid] = *imax;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        for (int s = WG / 2; s > 0; s >>= 1) {
+            if (lid < s) {
+                if (BETTER(lmin[lid + s], jmin[lid + s], lmin[lid], jmin[lid], LT)) {
+                    lmin[lid] = lmin[lid + s]; jmin[lid] = jmin[lid + s];
+                }
+                if (BETTER(lmax[lid + s], jmax[lid + s], lmax[lid], jmax[lid], GT)) {
+                    lmax[lid] = lmax[lid + s]; jmax[lid] = jmax[lid + s];
+                }
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    #endif
+        barrier(CLK_LOCAL_MEM_FENCE);
+        *vmin = lmin[0]; *imin = jmin[0];
+        *vmax = lmax[0]; *imax = jmax[0];
+    }
+
+    __kernel void sumStage1(__global const T* in, ulong n, __global SUM* partial)
+    {
+        __local SUM scratch[WG];
+        SUM acc = 0;
+        for (ulong i = get_global_id(0); i < n; i += get_global_size(0))
+            acc += (SUM)LOAD(in, i);
+        acc = groupSum(acc, scratch);
+        if (get_local_id(0) == 0)
+            partial[get_group_id(0)] = acc;
+    }
+
+    __kernel void sumStage2(__global const SUM* partial, uint groups, __global SUM* out)
+    {
+        __local SUM scratch[WG];
+        SUM acc = 0;
+        for (uint i = get_local_id(0); i < groups; i += WG)
+            acc += partial[i];
+        acc = groupSum(acc, scratch);
+        if (get_local_id(0) == 0)
+            out[0] = acc;
+    }
+
+    // partials: pval[2g] = min, pval[2g+1] = max, same layout for pidx
+    __kernel void minMaxStage1(__global const T* in, ulong n, __global VAL* pval, __global ulong* pidx)
+    {
+        __local VAL lmin[WG], lmax[WG];
+        __local ulong jmin[WG], jmax[WG];
+        VAL vmin = VAL_MAX, vmax = -VAL_MAX;
+        ulong imin = NO_INDEX, imax = NO_INDEX;
+        for (ulong i = get_global_id(0); i < n; i += get_global_size(0)) {
+            VAL v = (VAL)LOAD(in, i);
+            // strided walk visits indices in increasing order: strict compare keeps the first
+            if (imin == NO_INDEX || v < vmin) { vmin = v; imin = i; }
+            if (imax == NO_INDEX || v > vmax) { vmax = v; imax = i; }
+        }
+        groupMinMax(&vmin, &imin, &vmax, &imax, lmin, jmin, lmax, jmax);
+        if (get_local_id(0) == 0) {
+            uint g = get_group_id(0);
+            pval[2 * g] = vmin; pidx[2 * g] = imin;
+            pval[2 * g + 1] = vmax; pidx[2 * g + 1] = imax;
+        }
+    }
+
+    __kernel void minMaxStage2(__global const VAL* pval, __global const ulong* pidx, uint groups,
+                               __global VAL* oval, __global ulong* oidx)
+    {
+        __local VAL lmin[WG], lmax[WG];
+        __local ulong jmin[WG], jmax[WG];
+        VAL vmin = VAL_MAX, vmax = -VAL_MAX;
+        ulong imin = NO_INDEX, imax = NO_INDEX;
+        for (uint g = get_local_id(0); g < groups; g += WG) {
+            if (BETTER(pval[2 * g], pidx[2 * g], vmin, imin, LT)) { vmin = pval[2 * g]; imin = pidx[2 * g]; }
+            if (BETTER(pval[2 * g + 1], pidx[2 * g + 1], vmax, imax, GT)) { vmax = pval[2 * g + 1]; imax = pidx[2 * g + 1]; }
+        }
+        groupMinMax(&vmin, &imin, &vmax, &imax, lmin, jmin, lmax, jmax);
+        if (get_local_id(0) == 0) {
+            oval[0] = vmin; oidx[0] = imin;
+            oval[1] = vmax; oidx[1] = imax;
+        }
+    }
+)";
+
+struct MinMaxResult {
+    double minVal = 0.0;
+    size_t minIdx = 0;
+    double maxVal = 0.0;
+    size_t maxIdx = 0;
+};
+
+class Reducer {
+public:
+    Reducer(OclEnv& env, ElemType type, bool useSubgroups = true) : env_(env), type_(type) {
+        wg_ = (int)std::min<size_t>(256, env.device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+        groups_ = (int)env.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * 4;
+        std::string opts = "-D ELEM=" + std::to_string((int)type) + " -D WG=" + std::to_string(wg_);
+        subgroups_ = useSubgroups && env.subgroups;
+        if (subgroups_)
+            opts += " -cl-std=CL2.0 -D USE_SUBGROUPS";
+        program_ = buildProgram(env, reduceSource, opts);
+        sum1_ = cl::Kernel(program_, "sumStage1");
+        sum2_ = cl::Kernel(program_, "sumStage2");
+        mm1_ = cl::Kernel(program_, "minMaxStage1");
+        mm2_ = cl::Kernel(program_, "minMaxStage2");
+
+        // partials sized for the widest case: 2 x 8 bytes per group
+        partVal_ = cl::Buffer(env.context, CL_MEM_READ_WRITE, 2 * sizeof(cl_long) * groups_);
+        partIdx_ = cl::Buffer(env.context, CL_MEM_READ_WRITE, 2 * sizeof(cl_ulong) * groups_);
+        outVal_ = cl::Buffer(env.context, CL_MEM_READ_WRITE, 2 * sizeof(cl_long));
+        outIdx_ = cl::Buffer(env.context, CL_MEM_READ_WRITE, 2 * sizeof(cl_ulong));
+    }
+
+    ElemType type() const { return type_; }
+    bool subgroups() const { return subgroups_; }
+
+    double sum(const DeviceArray& in, size_t n) {
+        in.setArg(sum1_, 0);
+        sum1_.setArg(1, (cl_ulong)n);
+        sum1_.setArg(2, partVal_);
+        env_.queue.enqueueNDRangeKernel(sum1_, cl::NullRange, cl::NDRange((size_t)groups_ * wg_), cl::NDRange(wg_));
+
+        sum2_.setArg(0, partVal_);
+        sum2_.setArg(1, (cl_uint)groups_);
+        sum2_.setArg(2, outVal_);
+        env_.queue.enqueueNDRangeKernel(sum2_, cl::NullRange, cl::NDRange(wg_), cl::NDRange(wg_));
+
+        if (type_ == ElemType::Int) {
+            cl_long s = 0;
+            env_.queue.enqueueReadBuffer(outVal_, CL_TRUE, 0, sizeof(s), &s);
+            return (double)s;
+        }
+        float s = 0.f;
+        env_.queue.enqueueReadBuffer(outVal_, CL_TRUE, 0, sizeof(s), &s);
+        return s;
+    }
+
+    MinMaxResult minMax(const DeviceArray& in, size_t n) {
+        in.setArg(mm1_, 0);
+        mm1_.setArg(1, (cl_ulong)n);
+        mm1_.setArg(2, partVal_);
+        mm1_.setArg(3, partIdx_);
+        env_.queue.enqueueNDRangeKernel(mm1_, cl::NullRange, cl::NDRange((size_t)groups_ * wg_), cl::NDRange(wg_));
+
+        mm2_.setArg(0, partVal_);
+        mm2_.setArg(1, partIdx_);
+        mm2_.setArg(2, (cl_uint)groups_);
+        mm2_.setArg(3, outVal_);
+        mm2_.setArg(4, outIdx_);
+        env_.queue.enqueueNDRangeKernel(mm2_, cl::NullRange, cl::NDRange(wg_), cl::NDRange(wg_));
+
+        MinMaxResult r;
+        cl_ulong idx[2] = {0, 0};
+        env_.queue.enqueueReadBuffer(outIdx_, CL_FALSE, 0, sizeof(idx), idx);
+        if (type_ == ElemType::Int) {
+            cl_int v[2] = {0, 0};
+            env_.queue.enqueueReadBuffer(outVal_, CL_TRUE, 0, sizeof(v), v);
+            r.minVal = v[0];
+            r.maxVal = v[1];
+        } else {
+            float v[2] = {0.f, 0.f};
+            env_.queue.enqueueReadBuffer(outVal_, CL_TRUE, 0, sizeof(v), v);
+            r.minVal = v[0];
+            r.maxVal = v[1];
+        }
+        r.minIdx = (size_t)idx[0];
+        r.maxIdx = (size_t)idx[1];
+        return r;
+    }
+
+    // bandwidth bound: the max half of minMax comes for free
+    size_t argmin(const DeviceArray& in, size_t n) {
+        return minMax(in, n).minIdx;
+    }
+
+private:
+    OclEnv& env_;
+    ElemType type_;
+    int wg_ = 256;
+    int groups_ = 64;
+    bool subgroups_ = false;
+    cl::Program program_;
+    cl::Kernel sum1_, sum2_, mm1_, mm2_;
+    cl::Buffer partVal_, partIdx_, outVal_, outIdx_;
+};
+
+// IEEE half <-> float on the host, for test data and checks
+static uint16_t floatToHalf(float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    int32_t exp = (int32_t)((x >> 23) & 0xff) - 127 + 15;
+    uint32_t mant = x & 0x7fffff;
+    if (exp <= 0) return (uint16_t)sign;                       // flush tiny values to zero
+    if (exp >= 31) return (uint16_t)(sign | 0x7c00);           // overflow to inf
+    uint32_t h = sign | ((uint32_t)exp << 10) | (mant >> 13);
+    if ((mant >> 12) & 1) h++;                                   // round half up
+    return (uint16_t)h;
+}
+
+static float halfToFloat(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1f;
+    uint32_t mant = h & 0x3ff;
+    uint32_t x;
+    if (exp == 0) {
+        float f = std::ldexp((float)mant, -24);
+        return sign ? -f : f;
+    }
+    if (exp == 31) x = sign | 0x7f800000 | (mant << 13);
+    else x = sign | ((exp - 15 + 127) << 23) | (mant << 13);
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
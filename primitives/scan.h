@@ -0,0 +1,198 @@
+#pragma once
+
+// Work-efficient exclusive prefix sum and stream compaction.
+//
+// Scanner is the three-phase Blelloch scan: each work-group scans 2*WG
+// elements in local memory (up-sweep / down-sweep) and writes its total, the
+// totals are scanned recursively, then added back to every block. Decoupled
+// look-back is not used: it spins on the state of earlier work-groups, and
+// OpenCL makes no forward-progress promise between work-groups.
+//
+// Compactor keeps the elements that satisfy a predicate, in order:
+// flags -> exclusive scan -> scatter. The predicate is an OpenCL expression of
+// `x`, compiled into the kernels, e.g. "x > 0" or "(x & 1) == 0".
+
+#include "ocl_env.h"
+#include "reduce.h"
+
+static const char* scanSource = R"(
+    // exclusive Blelloch scan of one 2*WG block, block total to sums[group]
+    __kernel void scanBlocks(__global const uint* in, __global uint* out, uint n, __global uint* sums)
+    {
+        __local uint tmp[2 * WG];
+        int lid = get_local_id(0);
+        uint base = get_group_id(0) * 2 * WG;
+        uint a = base + lid;
+        uint b = base + lid + WG;
+        tmp[lid] = a < n ? in[a] : 0;
+        tmp[lid + WG] = b < n ? in[b] : 0;
+
+        int offset = 1;
+        for (int d = WG; d > 0; d >>= 1) {
+            barrier(CLK_LOCAL_MEM_FENCE);
+            if (lid < d) {
+                int ai = offset * (2 * lid + 1) - 1;
+                int bi = offset * (2 * lid + 2) - 1;
+                tmp[bi] += tmp[ai];
+            }
+            offset <<= 1;
+        }
+        if (lid == 0) {
+            sums[get_group_id(0)] = tmp[2 * WG - 1];
+            tmp[2 * WG - 1] = 0;
+        }
+        for (int d = 1; d < 2 * WG; d <<= 1) {
+            offset >>= 1;
+            barrier(CLK_LOCAL_MEM_FENCE);
+            if (lid < d) {
+                int ai = offset * (2 * lid + 1) - 1;
+                int bi = offset * (2 * lid + 2) - 1;
+                uint t = tmp[ai];
+                tmp[ai] = tmp[bi];
+                tmp[bi] += t;
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (a < n) out[a] = tmp[lid];
+        if (b < n) out[b] = tmp[lid + WG];
+    }
+
+    __kernel void addOffsets(__global uint* out, uint n, __global const uint* sums)
+    {
+        uint s = sums[get_group_id(0)];
+        uint base = get_group_id(0) * 2 * WG;
+        uint a = base + get_local_id(0);
+        uint b = a + WG;
+        if (a < n) out[a] += s;
+        if (b < n) out[b] += s;
+    }
+)";
+
+static const char* compactSource = R"(
+    #if ELEM == 0
+        typedef float T;
+    #else
+        typedef int T;
+    #endif
+    __kernel void compactFlags(__global const T* in, uint n, __global uint* flags)
+    {
+        uint i = get_global_id(0);
+        if (i < n) {
+            T x = in[i];
+            flags[i] = KEEP(x) ? 1 : 0;
+        }
+    }
+
+    __kernel void compactScatter(__global const T* in, uint n, __global const uint* pos, __global T* out)
+    {
+        uint i = get_global_id(0);
+        if (i < n) {
+            T x = in[i];
+            if (KEEP(x))
+                out[pos[i]] = x;
+        }
+    }
+)";
+
+static size_t roundUp(size_t n, size_t m) {
+    return (n + m - 1) / m * m;
+}
+
+class Scanner {
+public:
+    explicit Scanner(OclEnv& env) : env_(env) {
+        wg_ = (int)std::min<size_t>(256, env.device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+        program_ = buildProgram(env, scanSource, "-D WG=" + std::to_string(wg_));
+        scanKernel_ = cl::Kernel(program_, "scanBlocks");
+        addKernel_ = cl::Kernel(program_, "addOffsets");
+        // one level per factor of 2*WG, never resized: outer levels hold references
+        sums_.resize(8);
+    }
+
+    // exclusive prefix sum of n uints, `in` may be `out`; returns the total
+    cl_uint exclusive(const DeviceArray& in, DeviceArray& out, size_t n) {
+        if (n == 0) return 0;
+        if (n > 0xffffffffu)
+            throw std::runtime_error("Scanner: more than 2^32 elements");
+        return scanLevel(in, out, n, 0);
+    }
+
+    int workGroupSize() const { return wg_; }
+
+private:
+    cl_uint scanLevel(const DeviceArray& in, DeviceArray& out, size_t n, size_t level) {
+        size_t block = 2 * (size_t)wg_;
+        size_t groups = (n + block - 1) / block;
+        if (sums_[level].bytes() < groups * sizeof(cl_uint))
+            sums_[level] = DeviceArray(env_, MemKind::Buffer, groups * sizeof(cl_uint));
+        DeviceArray& sums = sums_[level];
+
+        in.setArg(scanKernel_, 0);
+        out.setArg(scanKernel_, 1);
+        scanKernel_.setArg(2, (cl_uint)n);
+        sums.setArg(scanKernel_, 3);
+        env_.queue.enqueueNDRangeKernel(scanKernel_, cl::NullRange, cl::NDRange(groups * wg_), cl::NDRange(wg_));
+
+        if (groups == 1) {
+            cl_uint total = 0;
+            sums.read(&total, sizeof(total));
+            return total;
+        }
+        cl_uint total = scanLevel(sums, sums, groups, level + 1);
+
+        out.setArg(addKernel_, 0);
+        addKernel_.setArg(1, (cl_uint)n);
+        sums.setArg(addKernel_, 2);
+        env_.queue.enqueueNDRangeKernel(addKernel_, cl::NullRange, cl::NDRange(groups * wg_), cl::NDRange(wg_));
+        return total;
+    }
+
+    OclEnv& env_;
+    int wg_ = 256;
+    cl::Program program_;
+    cl::Kernel scanKernel_, addKernel_;
+    std::vector<DeviceArray> sums_;   // block totals per recursion level
+};
+
+class Compactor {
+public:
+    // type: ElemType::Float or ElemType::Int, pred: OpenCL expression of x
+    Compactor(OclEnv& env, Scanner& scanner, ElemType type, const std::string& pred)
+        : env_(env), scanner_(scanner) {
+        if (type == ElemType::Half)
+            throw std::runtime_error("Compactor: half is not supported");
+        std::string source = "#define KEEP(x) (" + pred + ")\n" + compactSource;
+        program_ = buildProgram(env, source, "-D ELEM=" + std::to_string((int)type));
+        flagsKernel_ = cl::Kernel(program_, "compactFlags");
+        scatterKernel_ = cl::Kernel(program_, "compactScatter");
+    }
+
+    // out needs room for n elements in the worst case; returns how many were kept
+    size_t compact(const DeviceArray& in, size_t n, DeviceArray& out) {
+        if (n == 0) return 0;
+        if (pos_.bytes() < n * sizeof(cl_uint))
+            pos_ = DeviceArray(env_, MemKind::Buffer, n * sizeof(cl_uint));
+        cl::NDRange global(roundUp(n, 256));
+
+        in.setArg(flagsKernel_, 0);
+        flagsKernel_.setArg(1, (cl_uint)n);
+        pos_.setArg(flagsKernel_, 2);
+        env_.queue.enqueueNDRangeKernel(flagsKernel_, cl::NullRange, global, cl::NullRange);
+
+        cl_uint kept = scanner_.exclusive(pos_, pos_, n);
+
+        in.setArg(scatterKernel_, 0);
+        scatterKernel_.setArg(1, (cl_uint)n);
+        pos_.setArg(scatterKernel_, 2);
+        out.setArg(scatterKernel_, 3);
+        env_.queue.enqueueNDRangeKernel(scatterKernel_, cl::NullRange, global, cl::NullRange);
+        return kept;
+    }
+
+private:
+    OclEnv& env_;
+    Scanner& scanner_;
+    cl::Program program_;
+    cl::Kernel flagsKernel_, scatterKernel_;
+    DeviceArray pos_;
+};
@@ -0,0 +1,87 @@
+// Fused expression vs the chained one-kernel-per-operator style of
+// test_ocl-multi-devices.cpp (vectorAdd, then vectorSub, ...).
+//
+//   chained:  t = a + b;  u = d * 2;  c = t - u;   3 launches, 5 reads + 3 writes
+//   fused:    c = a + b - d * 2;                   1 launch,   3 reads + 1 write
+//
+// usage: ./app [elems] [runs]
+
+#include "ocl_env.h"
+#include "expr.h"
+
+#include <cmath>
+#include <cstdlib>
+
+using namespace expr;
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t)32 << 20;
+    int runs = argc > 2 ? atoi(argv[2]) : 10;
+
+    try {
+        OclEnv env = OclEnv::create();
+        ExprContext ctx(env);
+
+        std::vector<float> ha(n), hb(n), hd(n);
+        for (size_t i = 0; i < n; ++i) {
+            ha[i] = (float)(i % 1000);
+            hb[i] = (float)(i % 7) * 0.5f;
+            hd[i] = (float)(i % 13) * 0.25f;
+        }
+        DArray a(ctx, n), b(ctx, n), c(ctx, n), d(ctx, n), t(ctx, n), u(ctx, n);
+        a.write(ha);
+        b.write(hb);
+        d.write(hd);
+
+        // warm-up call builds the kernels
+        double tChained = timeRuns(env, runs, [&] {
+            t = a + b;
+            u = d * 2.f;
+            c = t - u;
+        }, true);
+        std::vector<float> chained;
+        c.read(chained);
+
+        size_t launchesBefore = ctx.launches();
+        double tFused = timeRuns(env, runs, [&] { c = a + b - d * 2.f; }, true);
+        size_t fusedLaunches = (ctx.launches() - launchesBefore) / (runs + 1);
+        std::vector<float> fused;
+        c.read(fused);
+
+        int errors = 0;
+        for (size_t i = 0; i < n; ++i) {
+            float ref = ha[i] + hb[i] - hd[i] * 2.f;
+            if (std::fabs(fused[i] - ref) > 1e-5f * std::max(1.f, std::fabs(ref)) ||
+                std::fabs(chained[i] - ref) > 1e-5f * std::max(1.f, std::fabs(ref)))
+                errors++;
+        }
+
+        // same shape, other scalar: no new kernel
+        size_t built = ctx.kernelsBuilt();
+        c = a + b - d * 3.f;
+        size_t rebuilt = ctx.kernelsBuilt() - built;
+        c = c * 0.5f + a;   // destination as input
+        std::vector<float> aliased;
+        c.read(aliased);
+        int aliasErrors = 0;
+        for (size_t i = 0; i < n; ++i) {
+            float ref = (ha[i] + hb[i] - hd[i] * 3.f) * 0.5f + ha[i];
+            if (std::fabs(aliased[i] - ref) > 1e-5f * std::max(1.f, std::fabs(ref)))
+                aliasErrors++;
+        }
+
+        double mb = n * sizeof(float) / 1e6;
+        printf("elements: %zu\n", n);
+        printf("chained: %8.3f ms  3 launches, %6.0f MB moved, %7.1f GB/s\n", tChained * 1e3, 8 * mb, 8 * mb / tChained / 1e3);
+        printf("fused:   %8.3f ms  %zu launch,   %6.0f MB moved, %7.1f GB/s\n", tFused * 1e3, fusedLaunches, 4 * mb, 4 * mb / tFused / 1e3);
+        printf("speedup: %.2fx\n", tChained / tFused);
+        printf("kernels built: %zu (re-running the shape with another scalar added %zu)  %s\n", ctx.kernelsBuilt(),
+               rebuilt, rebuilt == 0 ? "ok" : "REBUILT");
+        printf("mismatches: %d, destination-as-input mismatches: %d\n", errors, aliasErrors);
+        return errors == 0 && aliasErrors == 0 && rebuilt == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
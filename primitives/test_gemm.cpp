@@ -0,0 +1,117 @@
+// GFLOP/s of the tiled, autotuned GEMM against the naive one-element-per-
+// work-item kernel, then many small GEMMs batched into one launch against one
+// launch per matrix. Results are spot-checked against a double-precision host
+// product.
+//
+// usage: ./app [max_size] [batch]
+
+#include "ocl_env.h"
+#include "gemm.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+// checks `samples` random entries of C = A * B (A: M x K, B: K x N)
+static bool spotCheck(const std::vector<float>& A, const std::vector<float>& B, const std::vector<float>& C,
+                      int M, int N, int K, int samples, std::mt19937& rng) {
+    for (int s = 0; s < samples; ++s) {
+        int i = rng() % M, j = rng() % N;
+        double ref = 0.0;
+        for (int k = 0; k < K; ++k)
+            ref += (double)A[(size_t)i * K + k] * B[(size_t)k * N + j];
+        if (std::fabs(C[(size_t)i * N + j] - ref) > 1e-3 * K)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int maxSize = argc > 1 ? atoi(argv[1]) : 2048;
+    int batch = argc > 2 ? atoi(argv[2]) : 65536;
+
+    try {
+        OclEnv env = OclEnv::create();
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+        GemmConfig cfg = autotuneGemm(env);
+        Gemm tiled(env, cfg);
+        GemmNaive naive(env);
+        int failures = 0;
+
+        printf("%-6s %-6s %-6s %12s %12s %8s %s\n", "M", "N", "K", "naive_GF/s", "tiled_GF/s", "speedup", "check");
+        // odd sizes exercise the edge tiles
+        std::vector<int> sizes;
+        for (int s = 256; s <= maxSize; s *= 2)
+            sizes.push_back(s);
+        sizes.push_back(1000);
+        for (int s : sizes) {
+            int M = s, N = s, K = s;
+            std::vector<float> A((size_t)M * K), B((size_t)K * N), C((size_t)M * N);
+            for (auto& x : A) x = dist(rng);
+            for (auto& x : B) x = dist(rng);
+            DeviceArray dA(env, MemKind::Buffer, A.size() * sizeof(float));
+            DeviceArray dB(env, MemKind::Buffer, B.size() * sizeof(float));
+            DeviceArray dC(env, MemKind::Buffer, C.size() * sizeof(float));
+            dA.write(A);
+            dB.write(B);
+
+            double flops = 2.0 * M * N * K;
+            double tn = timeRuns(env, 3, [&] { naive.run(dA, dB, dC, M, N, K); }, true);
+            double tt = timeRuns(env, 5, [&] { tiled.run(dA, dB, dC, M, N, K); }, true);
+            dC.read(C);
+            bool ok = spotCheck(A, B, C, M, N, K, 64, rng);
+            failures += ok ? 0 : 1;
+            printf("%-6d %-6d %-6d %12.1f %12.1f %7.1fx %s\n", M, N, K, flops / tn / 1e9, flops / tt / 1e9, tn / tt,
+                   ok ? "ok" : "MISMATCH");
+        }
+
+        BatchedGemm batched(env);
+        printf("\n%-10s %8s %9s %14s %14s %8s %s\n", "shape", "batch", "items/mat", "batched_GF/s", "per_launch_GF/s",
+               "speedup", "check");
+        // 32x32 has more elements than many devices allow work-items per
+        // group; BatchedGemm then gives each work-item several elements
+        for (int s : {4, 8, 16, 32}) {
+            size_t matA = (size_t)s * s;
+            std::vector<float> A(matA * batch), B(matA * batch), C(matA * batch);
+            for (auto& x : A) x = dist(rng);
+            for (auto& x : B) x = dist(rng);
+            DeviceArray dA(env, MemKind::Buffer, A.size() * sizeof(float));
+            DeviceArray dB(env, MemKind::Buffer, B.size() * sizeof(float));
+            DeviceArray dC(env, MemKind::Buffer, C.size() * sizeof(float));
+            dA.write(A);
+            dB.write(B);
+
+            double flops = 2.0 * s * s * s * batch;
+            double tb = timeRuns(env, 5, [&] { batched.run(dA, dB, dC, batch, s, s, s); }, true);
+            dC.read(C);
+
+            // one naive launch per matrix, on a sample so the run stays short
+            int sample = std::min(batch, 1024);
+            std::vector<DeviceArray> one;
+            for (int m = 0; m < 3; ++m)
+                one.emplace_back(env, MemKind::Buffer, matA * sizeof(float));
+            double tl = timeRuns(env, 3, [&] {
+                for (int b = 0; b < sample; ++b)
+                    naive.run(one[0], one[1], one[2], s, s, s);
+            }, true) * batch / sample;
+
+            bool ok = true;
+            for (int b = 0; ok && b < batch; b += std::max(1, batch / 16)) {
+                std::vector<float> a(A.begin() + b * matA, A.begin() + (b + 1) * matA);
+                std::vector<float> bb(B.begin() + b * matA, B.begin() + (b + 1) * matA);
+                std::vector<float> c(C.begin() + b * matA, C.begin() + (b + 1) * matA);
+                ok = spotCheck(a, bb, c, s, s, s, 8, rng);
+            }
+            failures += ok ? 0 : 1;
+            printf("%2dx%-2dx%-3d %8d %9d %14.2f %14.2f %7.1fx %s\n", s, s, s, batch, batched.itemsPerMatrix(s, s, s),
+                   flops / tb / 1e9, flops / tl / 1e9, tl / tb, ok ? "ok" : "MISMATCH");
+        }
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,128 @@
+// GPU sum / min-max-with-index / argmin vs the host verification loop.
+//
+// For every element type and memory kind the data is uploaded once, then
+//   gpu:        Reducer::sum + Reducer::minMax, result read back (a few bytes)
+//   host:       read the whole array back and walk it, as test_ocl_svm.cpp does
+//   host loop:  the walk alone, data already on the host
+//
+// usage: ./app [max_elems] [runs]
+
+#include "ocl_env.h"
+#include "reduce.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+struct HostResult {
+    double sum = 0.0;
+    MinMaxResult mm;
+};
+
+template <typename T, typename F>
+static HostResult hostReduce(const std::vector<T>& v, F toValue) {
+    HostResult r;
+    double vmin = 0.0, vmax = 0.0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        double x = toValue(v[i]);
+        r.sum += x;
+        if (i == 0 || x < vmin) { vmin = x; r.mm.minIdx = i; }
+        if (i == 0 || x > vmax) { vmax = x; r.mm.maxIdx = i; }
+    }
+    r.mm.minVal = vmin;
+    r.mm.maxVal = vmax;
+    return r;
+}
+
+static HostResult hostReduceRaw(ElemType type, const std::vector<char>& raw, size_t n) {
+    if (type == ElemType::Float) {
+        std::vector<float> v((const float*)raw.data(), (const float*)raw.data() + n);
+        return hostReduce(v, [](float x) { return (double)x; });
+    }
+    if (type == ElemType::Int) {
+        std::vector<int> v((const int*)raw.data(), (const int*)raw.data() + n);
+        return hostReduce(v, [](int x) { return (double)x; });
+    }
+    std::vector<uint16_t> v((const uint16_t*)raw.data(), (const uint16_t*)raw.data() + n);
+    return hostReduce(v, [](uint16_t x) { return (double)halfToFloat(x); });
+}
+
+static std::vector<char> makeData(ElemType type, size_t n, std::mt19937& rng) {
+    std::vector<char> raw(n * elemSize(type));
+    for (size_t i = 0; i < n; ++i) {
+        // small integers: exact in every type, many ties for min / max
+        int x = (int)(rng() % 2001) - 1000;
+        if (type == ElemType::Float) ((float*)raw.data())[i] = x * 0.25f;
+        else if (type == ElemType::Int) ((int*)raw.data())[i] = x;
+        else ((uint16_t*)raw.data())[i] = floatToHalf(x * 0.25f);
+    }
+    return raw;
+}
+
+int main(int argc, char** argv) {
+    size_t maxElems = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t)64 << 20;
+    int runs = argc > 2 ? atoi(argv[2]) : 10;
+
+    try {
+        OclEnv env = OclEnv::create();
+        std::cout << "subgroups: " << (env.subgroups ? "yes" : "no") << std::endl;
+        std::mt19937 rng(37);
+
+        printf("%-6s %-7s %10s %10s %10s %12s %8s %s\n", "type", "memory", "elems", "gpu_ms", "host_ms", "host_loop_ms", "speedup", "check");
+        int failures = 0;
+        for (ElemType type : {ElemType::Float, ElemType::Int, ElemType::Half}) {
+            Reducer reducer(env, type);
+            for (MemKind kind : {MemKind::Buffer, MemKind::Svm, MemKind::Usm}) {
+                if (!memKindSupported(env, kind)) {
+                    std::cout << "skip " << memKindName(kind) << ": not supported" << std::endl;
+                    continue;
+                }
+                for (size_t n = 1 << 20; n <= maxElems; n *= 4) {
+                    std::vector<char> raw = makeData(type, n, rng);
+                    DeviceArray dev(env, kind, raw.size());
+                    dev.write(raw);
+
+                    double sum = reducer.sum(dev, n);   // warm up
+                    MinMaxResult mm = reducer.minMax(dev, n);
+
+                    std::vector<double> tg, th, tl;
+                    std::vector<char> back(raw.size());
+                    HostResult ref;
+                    for (int r = 0; r < runs; ++r) {
+                        auto t0 = std::chrono::high_resolution_clock::now();
+                        sum = reducer.sum(dev, n);
+                        mm = reducer.minMax(dev, n);
+                        auto t1 = std::chrono::high_resolution_clock::now();
+                        dev.read(back);
+                        auto t2 = std::chrono::high_resolution_clock::now();
+                        ref = hostReduceRaw(type, back, n);
+                        auto t3 = std::chrono::high_resolution_clock::now();
+                        tg.push_back(std::chrono::duration<double>(t1 - t0).count());
+                        th.push_back(std::chrono::duration<double>(t3 - t1).count());
+                        tl.push_back(std::chrono::duration<double>(t3 - t2).count());
+                    }
+
+                    // float sums are reassociated on the GPU: compare relatively
+                    bool ok = mm.minIdx == ref.mm.minIdx && mm.maxIdx == ref.mm.maxIdx &&
+                              mm.minVal == ref.mm.minVal && mm.maxVal == ref.mm.maxVal &&
+                              std::fabs(sum - ref.sum) <= 1e-4 * std::max(1.0, std::fabs(ref.sum)) + (type == ElemType::Int ? 0.0 : 1.0);
+                    failures += ok ? 0 : 1;
+                    double g = medianOf(tg), h = medianOf(th), l = medianOf(tl);
+                    printf("%-6s %-7s %10zu %10.3f %10.3f %12.3f %7.1fx %s\n", elemTypeName(type), memKindName(kind), n,
+                           g * 1e3, h * 1e3, l * 1e3, h / g, ok ? "ok" : "MISMATCH");
+                    if (!ok) {
+                        printf("    gpu sum %.3f min %.2f@%zu max %.2f@%zu | host sum %.3f min %.2f@%zu max %.2f@%zu\n",
+                               sum, mm.minVal, mm.minIdx, mm.maxVal, mm.maxIdx,
+                               ref.sum, ref.mm.minVal, ref.mm.minIdx, ref.mm.maxVal, ref.mm.maxIdx);
+                    }
+                }
+            }
+        }
+        std::cout << (failures == 0 ? "All reductions match the host loop." : "Some reductions differ from the host loop.") << std::endl;
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
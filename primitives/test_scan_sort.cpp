@@ -0,0 +1,163 @@
+// Throughput of exclusive scan, stream compaction and radix sort on buffers,
+// SVM and USM device memory, checked against std:: on the host up to `verify_max` elements.
+//
+// usage: ./app [max_elems] [runs] [verify_max]
+//   ./app 1073741824 3      1 M .. 1 B elements, arrays that exceed the
+//                           device's max allocation are skipped (sort64
+//                           drops out one size before the 32-bit cases)
+
+#include "ocl_env.h"
+#include "scan.h"
+#include "radix_sort.h"
+
+#include <cstdlib>
+#include <iterator>
+#include <numeric>
+#include <random>
+
+static void report(const char* op, MemKind kind, size_t n, double seconds, int check) {
+    printf("%-12s %-7s %11zu %10.3f %10.1f %s\n", op, memKindName(kind), n, seconds * 1e3, n / seconds / 1e6,
+           check < 0 ? "-" : (check ? "ok" : "MISMATCH"));
+}
+
+int main(int argc, char** argv) {
+    size_t maxElems = argc > 1 ? strtoull(argv[1], nullptr, 10) : (size_t)64 << 20;
+    int runs = argc > 2 ? atoi(argv[2]) : 5;
+    size_t verifyMax = argc > 3 ? strtoull(argv[3], nullptr, 10) : (size_t)64 << 20;
+
+    try {
+        OclEnv env = OclEnv::create();
+        size_t maxAlloc = env.device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+        std::mt19937_64 rng(2024);
+
+        Scanner scanner(env);
+        Compactor compactor(env, scanner, ElemType::Int, "x > 0");
+        RadixSorter sort32(env, scanner, 32);
+        RadixSorter sort32kv(env, scanner, 32, true);
+        RadixSorter sort64(env, scanner, 64);
+
+        printf("%-12s %-7s %11s %10s %10s %s\n", "op", "memory", "elems", "ms", "Melem/s", "check");
+        int failures = 0;
+        for (MemKind kind : {MemKind::Buffer, MemKind::Svm, MemKind::Usm}) {
+            if (!memKindSupported(env, kind)) {
+                std::cout << "skip " << memKindName(kind) << ": not supported" << std::endl;
+                continue;
+            }
+            for (size_t n = 1 << 20; n <= maxElems; n *= 4) {
+                if (n * sizeof(cl_uint) > maxAlloc) {
+                    std::cout << "skip " << n << " elements: larger than CL_DEVICE_MAX_MEM_ALLOC_SIZE" << std::endl;
+                    break;
+                }
+                bool verify = n <= verifyMax;
+
+                // scan of small counts, as used by compaction / histograms
+                std::vector<cl_uint> counts(n);
+                for (auto& c : counts) c = (cl_uint)(rng() & 3);
+                DeviceArray in(env, kind, n * sizeof(cl_uint));
+                DeviceArray out(env, kind, n * sizeof(cl_uint));
+                in.write(counts);
+                cl_uint total = 0;
+                double t = timeRuns(env, runs, [&] { total = scanner.exclusive(in, out, n); });
+                int check = -1;
+                if (verify) {
+                    std::vector<cl_uint> got(n), ref(n);
+                    out.read(got);
+                    std::exclusive_scan(counts.begin(), counts.end(), ref.begin(), 0u);
+                    check = got == ref && total == ref.back() + counts.back();
+                }
+                failures += check == 0;
+                report("scan", kind, n, t, check);
+
+                // compaction keeping about half of the elements
+                std::vector<cl_int> vals(n);
+                for (auto& v : vals) v = (cl_int)(rng() % 2001) - 1000;
+                in.write(vals);
+                size_t kept = 0;
+                t = timeRuns(env, runs, [&] { kept = compactor.compact(in, n, out); });
+                check = -1;
+                if (verify) {
+                    std::vector<cl_int> ref;
+                    std::copy_if(vals.begin(), vals.end(), std::back_inserter(ref), [](cl_int x) { return x > 0; });
+                    std::vector<cl_int> got(kept);
+                    out.read(got.data(), kept * sizeof(cl_int));
+                    check = got == ref;
+                }
+                failures += check == 0;
+                report("compact", kind, n, t, check);
+
+                // 32-bit keys, keys only and with an index payload
+                std::vector<cl_uint> keys(n), idx(n);
+                for (auto& k : keys) k = (cl_uint)rng();
+                std::iota(idx.begin(), idx.end(), 0u);
+                DeviceArray vk(env, kind, n * sizeof(cl_uint));
+                std::vector<double> ts;
+                for (int r = 0; r < runs; ++r) {
+                    in.write(keys);
+                    ts.push_back(timeRuns(env, 1, [&] { sort32.sort(in, n); }));
+                }
+                check = -1;
+                if (verify) {
+                    std::vector<cl_uint> got(n), ref = keys;
+                    in.read(got);
+                    std::sort(ref.begin(), ref.end());
+                    check = got == ref;
+                }
+                failures += check == 0;
+                report("sort32", kind, n, medianOf(ts), check);
+
+                ts.clear();
+                for (int r = 0; r < runs; ++r) {
+                    in.write(keys);
+                    vk.write(idx);
+                    ts.push_back(timeRuns(env, 1, [&] { sort32kv.sort(in, n, &vk); }));
+                }
+                check = -1;
+                if (verify) {
+                    std::vector<cl_uint> gotK(n), gotV(n), ref(n);
+                    in.read(gotK);
+                    vk.read(gotV);
+                    std::iota(ref.begin(), ref.end(), 0u);
+                    std::stable_sort(ref.begin(), ref.end(), [&](cl_uint a, cl_uint b) { return keys[a] < keys[b]; });
+                    check = gotV == ref;
+                    for (size_t i = 0; check && i < n; ++i)
+                        check = gotK[i] == keys[ref[i]];
+                }
+                failures += check == 0;
+                report("sort32-kv", kind, n, medianOf(ts), check);
+                in = DeviceArray();
+                out = DeviceArray();
+                vk = DeviceArray();
+
+                // 64-bit keys
+                if (n * sizeof(cl_ulong) > maxAlloc) {
+                    std::cout << "skip sort64 of " << n << " elements: larger than CL_DEVICE_MAX_MEM_ALLOC_SIZE"
+                              << std::endl;
+                    continue;
+                }
+                std::vector<cl_ulong> keys64(n);
+                for (auto& k : keys64) k = rng();
+                DeviceArray in64(env, kind, n * sizeof(cl_ulong));
+                ts.clear();
+                for (int r = 0; r < runs; ++r) {
+                    in64.write(keys64);
+                    ts.push_back(timeRuns(env, 1, [&] { sort64.sort(in64, n); }));
+                }
+                check = -1;
+                if (verify) {
+                    std::vector<cl_ulong> got(n), ref = keys64;
+                    in64.read(got);
+                    std::sort(ref.begin(), ref.end());
+                    check = got == ref;
+                }
+                failures += check == 0;
+                report("sort64", kind, n, medianOf(ts), check);
+            }
+        }
+        std::cout << (failures == 0 ? "All checked results match the host." : "Some results differ from the host.") << std::endl;
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+// cl_intel_unified_shared_memory entry points, resolved per platform with
+// clGetExtensionFunctionAddressForPlatform so nothing here needs the Intel
+// headers or an Intel ICD to compile. Unlike the 822 tests, which call
+// clDeviceMemAllocINTEL & co. directly, a missing extension shows up as null
+// pointers (UsmApi::available() == false) instead of a link error.
+//
+// The one set of USM typedefs and the one loader: OclEnv carries a UsmApi,
+// and code with its own context setup calls UsmApi::load directly.
+
+#include <CL/cl2.hpp>
+
+#include <stdexcept>
+#include <string>
+
+typedef void* (*usmHostMemAllocFn)(cl_context, const cl_ulong*, size_t, cl_uint, cl_int*);
+typedef void* (*usmDeviceMemAllocFn)(cl_context, cl_device_id, const cl_ulong*, size_t, cl_uint, cl_int*);
+typedef void* (*usmSharedMemAllocFn)(cl_context, cl_device_id, const cl_ulong*, size_t, cl_uint, cl_int*);
+typedef cl_int (*usmMemFreeFn)(cl_context, void*);
+typedef cl_int (*usmSetKernelArgMemPointerFn)(cl_kernel, cl_uint, const void*);
+typedef cl_int (*usmEnqueueMemcpyFn)(cl_command_queue, cl_bool, void*, const void*, size_t, cl_uint, const cl_event*,
+                                     cl_event*);
+typedef cl_int (*usmEnqueueMemFillFn)(cl_command_queue, void*, const void*, size_t, size_t, cl_uint, const cl_event*,
+                                      cl_event*);
+typedef cl_int (*usmEnqueueMigrateMemFn)(cl_command_queue, const void*, size_t, cl_mem_migration_flags, cl_uint,
+                                         const cl_event*, cl_event*);
+typedef cl_int (*usmEnqueueMemAdviseFn)(cl_command_queue, const void*, size_t, cl_uint, cl_uint, const cl_event*,
+                                        cl_event*);
+
+enum class UsmKind { Host, Device, Shared };
+
+static const char* usmKindName(UsmKind kind) {
+    switch (kind) {
+    case UsmKind::Host: return "host";
+    case UsmKind::Device: return "device";
+    default: return "shared";
+    }
+}
+
+struct UsmApi {
+    usmHostMemAllocFn hostMemAlloc = nullptr;
+    usmDeviceMemAllocFn deviceMemAlloc = nullptr;
+    usmSharedMemAllocFn sharedMemAlloc = nullptr;
+    usmMemFreeFn memFree = nullptr;
+    usmMemFreeFn memBlockingFree = nullptr;
+    usmSetKernelArgMemPointerFn setKernelArgMemPointer = nullptr;
+    usmEnqueueMemcpyFn enqueueMemcpy = nullptr;
+    usmEnqueueMemFillFn enqueueMemFill = nullptr;
+    // optional: older drivers export the allocators but not these two
+    usmEnqueueMigrateMemFn enqueueMigrateMem = nullptr;
+    usmEnqueueMemAdviseFn enqueueMemAdvise = nullptr;
+
+    bool available() const {
+        return hostMemAlloc && deviceMemAlloc && sharedMemAlloc && memFree && memBlockingFree &&
+               setKernelArgMemPointer && enqueueMemcpy;
+    }
+
+    static UsmApi load(const cl::Platform& platform) {
+        cl_platform_id p = platform();
+        UsmApi api;
+        api.hostMemAlloc = (usmHostMemAllocFn)clGetExtensionFunctionAddressForPlatform(p, "clHostMemAllocINTEL");
+        api.deviceMemAlloc = (usmDeviceMemAllocFn)clGetExtensionFunctionAddressForPlatform(p, "clDeviceMemAllocINTEL");
+        api.sharedMemAlloc = (usmSharedMemAllocFn)clGetExtensionFunctionAddressForPlatform(p, "clSharedMemAllocINTEL");
+        api.memFree = (usmMemFreeFn)clGetExtensionFunctionAddressForPlatform(p, "clMemFreeINTEL");
+        api.memBlockingFree = (usmMemFreeFn)clGetExtensionFunctionAddressForPlatform(p, "clMemBlockingFreeINTEL");
+        api.setKernelArgMemPointer =
+            (usmSetKernelArgMemPointerFn)clGetExtensionFunctionAddressForPlatform(p, "clSetKernelArgMemPointerINTEL");
+        api.enqueueMemcpy = (usmEnqueueMemcpyFn)clGetExtensionFunctionAddressForPlatform(p, "clEnqueueMemcpyINTEL");
+        api.enqueueMemFill = (usmEnqueueMemFillFn)clGetExtensionFunctionAddressForPlatform(p, "clEnqueueMemFillINTEL");
+        api.enqueueMigrateMem =
+            (usmEnqueueMigrateMemFn)clGetExtensionFunctionAddressForPlatform(p, "clEnqueueMigrateMemINTEL");
+        api.enqueueMemAdvise =
+            (usmEnqueueMemAdviseFn)clGetExtensionFunctionAddressForPlatform(p, "clEnqueueMemAdviseINTEL");
+        return api;
+    }
+
+    // one driver allocation; throws on failure
+    void* alloc(UsmKind kind, const cl::Context& context, const cl::Device& device, size_t bytes,
+                cl_uint alignment = 0) const {
+        if (!available())
+            throw std::runtime_error("USM entry points not available");
+        cl_int err = CL_SUCCESS;
+        void* ptr = nullptr;
+        if (kind == UsmKind::Host)
+            ptr = hostMemAlloc(context(), nullptr, bytes, alignment, &err);
+        else if (kind == UsmKind::Device)
+            ptr = deviceMemAlloc(context(), device(), nullptr, bytes, alignment, &err);
+        else
+            ptr = sharedMemAlloc(context(), device(), nullptr, bytes, alignment, &err);
+        if (!ptr || err != CL_SUCCESS)
+            throw std::runtime_error(std::string("USM ") + usmKindName(kind) + " alloc of " + std::to_string(bytes) +
+                                     " bytes failed: " + std::to_string(err));
+        return ptr;
+    }
+
+    void setArg(cl::Kernel& kernel, cl_uint index, const void* ptr) const {
+        cl_int err = setKernelArgMemPointer(kernel(), index, ptr);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("clSetKernelArgMemPointerINTEL failed: " + std::to_string(err));
+    }
+
+    void memcpy(cl::CommandQueue& queue, void* dst, const void* src, size_t bytes, bool blocking = true) const {
+        cl_int err = enqueueMemcpy(queue(), blocking ? CL_TRUE : CL_FALSE, dst, src, bytes, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("clEnqueueMemcpyINTEL failed: " + std::to_string(err));
+    }
+};
@@ -0,0 +1,19 @@
+sudo apt install opencl-header ocl-icd-opencl-dev
+
+# sum / min-max with index / argmin for float, int, half on buffer, svm, usm
+source build.sh test_reduce.cpp
+./app 67108864 10 2>&1 | tee mylog
+
+# exclusive scan, compaction, 32/64-bit radix sort (keys and key-value) on buffer and svm
+source build.sh test_scan_sort.cpp
+./app 67108864 5 2>&1 | tee mylog
+./app 1073741824 3 16777216 2>&1 | tee mylog   # up to 1 B elements, verify up to 16 M
+
+# tiled / autotuned GEMM vs naive, batched small GEMMs vs one launch per matrix
+# the tuned tile config is cached per device in gemm-tune.cache
+source build.sh test_gemm.cpp
+./app 2048 65536 2>&1 | tee mylog
+
+# expression templates: c = a + b - d * 2 as one fused kernel vs chained kernels
+source build.sh test_expr.cpp
+./app 33554432 10 2>&1 | tee mylog
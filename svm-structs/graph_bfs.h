@@ -0,0 +1,238 @@
+#pragma once
+
+// Breadth-first search over a graph built from ordinary host allocations.
+//
+// PointerGraph mallocs every node and every adjacency array separately, the
+// way host code builds linked structures; nodes point at their neighbours.
+// With fine-grain system SVM (test_ocl-fine-grain-system-svm.cpp) a kernel
+// can follow those pointers as they are: SystemSvmBfs passes the malloc'd
+// frontier arrays with clSetKernelArgSVMPointer, enables
+// CL_KERNEL_EXEC_INFO_SVM_FINE_GRAIN_SYSTEM for everything reachable from
+// them, and claims nodes by atomic_cmpxchg on their `level`.
+//
+// Devices without system SVM get CsrBfs: flattenToCsr walks the pointers
+// once into row pointers / column indices (the serialization step system
+// SVM avoids), uploads them to cl::Buffers and runs the same
+// level-synchronous frontier expansion on indices, OpenCL 1.2 only.
+//
+// Both run one launch per level: expand the frontier, count the next one
+// with atomic_inc, stop when it is empty.
+
+#include "svm_common.h"
+
+#include <cstdlib>
+
+static const char* graphBfsSource = R"(
+typedef struct GraphNode {
+    uint id;
+    uint degree;
+    int level;
+    uint pad;
+    __global struct GraphNode* __global* neighbors;
+} GraphNode;
+
+__kernel void bfsPointers(__global GraphNode* __global* frontier, uint n, __global GraphNode* __global* next,
+                          volatile __global uint* nextCount, int level)
+{
+    uint i = get_global_id(0);
+    if (i >= n)
+        return;
+    __global GraphNode* u = frontier[i];
+    for (uint e = 0; e < u->degree; ++e) {
+        __global GraphNode* v = u->neighbors[e];
+        if (atomic_cmpxchg((volatile __global int*)&v->level, -1, level + 1) == -1)
+            next[atomic_inc(nextCount)] = v;
+    }
+}
+)";
+
+static const char* csrBfsSource = R"(
+__kernel void bfsCsr(__global const uint* rowPtr, __global const uint* col, volatile __global int* levels,
+                     __global const uint* frontier, uint n, __global uint* next,
+                     volatile __global uint* nextCount, int level)
+{
+    uint i = get_global_id(0);
+    if (i >= n)
+        return;
+    uint u = frontier[i];
+    for (uint e = rowPtr[u]; e < rowPtr[u + 1]; ++e) {
+        uint v = col[e];
+        if (atomic_cmpxchg(&levels[v], -1, level + 1) == -1)
+            next[atomic_inc(nextCount)] = v;
+    }
+}
+)";
+
+// host mirror of GraphNode
+struct GraphNode {
+    uint32_t id;
+    uint32_t degree;
+    int32_t level;
+    uint32_t pad;
+    GraphNode** neighbors;
+};
+static_assert(sizeof(GraphNode) == 24, "GraphNode must match the device struct");
+
+class PointerGraph {
+public:
+    explicit PointerGraph(uint32_t n) : nodes_(n, nullptr) {
+        for (uint32_t i = 0; i < n; ++i) {
+            nodes_[i] = static_cast<GraphNode*>(malloc(sizeof(GraphNode)));
+            if (!nodes_[i])
+                throw std::runtime_error("PointerGraph: out of memory");
+            *nodes_[i] = GraphNode{i, 0, -1, 0, nullptr};
+        }
+    }
+    PointerGraph(const PointerGraph&) = delete;
+    PointerGraph& operator=(const PointerGraph&) = delete;
+    ~PointerGraph() {
+        for (GraphNode* node : nodes_) {
+            free(node->neighbors);
+            free(node);
+        }
+    }
+
+    uint32_t size() const { return (uint32_t)nodes_.size(); }
+    GraphNode* node(uint32_t i) const { return nodes_[i]; }
+
+    void setNeighbors(uint32_t u, const std::vector<uint32_t>& adj) {
+        GraphNode* node = nodes_[u];
+        free(node->neighbors);
+        node->neighbors = static_cast<GraphNode**>(malloc(std::max<size_t>(adj.size(), 1) * sizeof(GraphNode*)));
+        if (!node->neighbors)
+            throw std::runtime_error("PointerGraph: out of memory");
+        for (size_t e = 0; e < adj.size(); ++e)
+            node->neighbors[e] = nodes_[adj[e]];
+        node->degree = (uint32_t)adj.size();
+    }
+
+    void resetLevels() {
+        for (GraphNode* node : nodes_)
+            node->level = -1;
+    }
+
+private:
+    std::vector<GraphNode*> nodes_;
+};
+
+// follows the pointers once; node ids become row indices
+static void flattenToCsr(const PointerGraph& g, std::vector<uint32_t>& rowPtr, std::vector<uint32_t>& col) {
+    rowPtr.assign(g.size() + 1, 0);
+    for (uint32_t u = 0; u < g.size(); ++u)
+        rowPtr[u + 1] = rowPtr[u] + g.node(u)->degree;
+    col.resize(rowPtr[g.size()]);
+    for (uint32_t u = 0; u < g.size(); ++u) {
+        const GraphNode* node = g.node(u);
+        for (uint32_t e = 0; e < node->degree; ++e)
+            col[rowPtr[u] + e] = node->neighbors[e]->id;
+    }
+}
+
+class SystemSvmBfs {
+public:
+    explicit SystemSvmBfs(OclEnv& env) : env_(env) {
+        if (!svmFineGrainSystem(env) || env.device.getInfo<CL_DEVICE_ADDRESS_BITS>() != 64)
+            throw std::runtime_error("SystemSvmBfs needs fine-grain system SVM with 64-bit pointers");
+        program_ = buildProgram(env, graphBfsSource, "-cl-std=CL2.0");
+        kernel_ = cl::Kernel(program_, "bfsPointers");
+        cl_bool on = CL_TRUE;
+        cl_int err = clSetKernelExecInfo(kernel_(), CL_KERNEL_EXEC_INFO_SVM_FINE_GRAIN_SYSTEM, sizeof(on), &on);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("clSetKernelExecInfo failed: " + std::to_string(err));
+    }
+
+    // fills node->level (-1: unreached); returns the number of levels
+    int run(PointerGraph& g, uint32_t source) {
+        g.resetLevels();
+        frontier_.resize(g.size());
+        next_.resize(g.size());
+        GraphNode** frontier = frontier_.data();
+        GraphNode** next = next_.data();
+
+        g.node(source)->level = 0;
+        frontier[0] = g.node(source);
+        uint32_t n = 1;
+        int level = 0;
+        for (; n > 0; ++level) {
+            nextCount_ = 0;
+            setSvmArg(kernel_, 0, frontier);
+            kernel_.setArg(1, (cl_uint)n);
+            setSvmArg(kernel_, 2, next);
+            setSvmArg(kernel_, 3, &nextCount_);
+            kernel_.setArg(4, (cl_int)level);
+            env_.queue.enqueueNDRangeKernel(kernel_, cl::NullRange, cl::NDRange((n + 255) / 256 * 256), cl::NDRange(256));
+            env_.queue.finish();
+            n = nextCount_;
+            std::swap(frontier, next);
+        }
+        return level;
+    }
+
+private:
+    OclEnv& env_;
+    cl::Program program_;
+    cl::Kernel kernel_;
+    // plain host memory, read by the kernel through system SVM
+    std::vector<GraphNode*> frontier_, next_;
+    uint32_t nextCount_ = 0;
+};
+
+class CsrBfs {
+public:
+    explicit CsrBfs(OclEnv& env) : env_(env) {
+        program_ = buildProgram(env, csrBfsSource);
+        kernel_ = cl::Kernel(program_, "bfsCsr");
+    }
+
+    void upload(const std::vector<uint32_t>& rowPtr, const std::vector<uint32_t>& col) {
+        n_ = (uint32_t)rowPtr.size() - 1;
+        rowPtr_ = cl::Buffer(env_.context, CL_MEM_READ_ONLY, rowPtr.size() * sizeof(uint32_t));
+        col_ = cl::Buffer(env_.context, CL_MEM_READ_ONLY, std::max<size_t>(col.size(), 1) * sizeof(uint32_t));
+        levels_ = cl::Buffer(env_.context, CL_MEM_READ_WRITE, std::max<uint32_t>(n_, 1) * sizeof(int32_t));
+        frontier_ = cl::Buffer(env_.context, CL_MEM_READ_WRITE, std::max<uint32_t>(n_, 1) * sizeof(uint32_t));
+        next_ = cl::Buffer(env_.context, CL_MEM_READ_WRITE, std::max<uint32_t>(n_, 1) * sizeof(uint32_t));
+        count_ = cl::Buffer(env_.context, CL_MEM_READ_WRITE, sizeof(uint32_t));
+        env_.queue.enqueueWriteBuffer(rowPtr_, CL_FALSE, 0, rowPtr.size() * sizeof(uint32_t), rowPtr.data());
+        if (!col.empty())
+            env_.queue.enqueueWriteBuffer(col_, CL_TRUE, 0, col.size() * sizeof(uint32_t), col.data());
+        env_.queue.finish();
+    }
+
+    // levels[v] = -1 for unreached; returns the number of levels
+    int run(uint32_t source, std::vector<int32_t>& levels) {
+        cl_int minusOne = -1, zero = 0;
+        env_.queue.enqueueFillBuffer(levels_, minusOne, 0, n_ * sizeof(int32_t));
+        env_.queue.enqueueWriteBuffer(levels_, CL_FALSE, source * sizeof(int32_t), sizeof(zero), &zero);
+        env_.queue.enqueueWriteBuffer(frontier_, CL_FALSE, 0, sizeof(source), &source);
+
+        cl::Buffer frontier = frontier_, next = next_;
+        uint32_t n = 1;
+        int level = 0;
+        for (; n > 0; ++level) {
+            cl_uint count = 0;
+            env_.queue.enqueueWriteBuffer(count_, CL_FALSE, 0, sizeof(count), &count);
+            kernel_.setArg(0, rowPtr_);
+            kernel_.setArg(1, col_);
+            kernel_.setArg(2, levels_);
+            kernel_.setArg(3, frontier);
+            kernel_.setArg(4, (cl_uint)n);
+            kernel_.setArg(5, next);
+            kernel_.setArg(6, count_);
+            kernel_.setArg(7, (cl_int)level);
+            env_.queue.enqueueNDRangeKernel(kernel_, cl::NullRange, cl::NDRange((n + 255) / 256 * 256), cl::NDRange(256));
+            env_.queue.enqueueReadBuffer(count_, CL_TRUE, 0, sizeof(count), &count);
+            n = count;
+            std::swap(frontier, next);
+        }
+        levels.resize(n_);
+        env_.queue.enqueueReadBuffer(levels_, CL_TRUE, 0, n_ * sizeof(int32_t), levels.data());
+        return level;
+    }
+
+private:
+    OclEnv& env_;
+    cl::Program program_;
+    cl::Kernel kernel_;
+    uint32_t n_ = 0;
+    cl::Buffer rowPtr_, col_, levels_, frontier_, next_, count_;
+};
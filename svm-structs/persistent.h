@@ -0,0 +1,317 @@
+#pragma once
+
+// Persistent-kernel task runtime: one long-running kernel occupies the device
+// and pulls task descriptors from a fine-grain SVM queue instead of paying an
+// enqueueNDRangeKernel submission per request.
+//
+//     TaskRuntime rt(env);
+//     float* a = rt.alloc(n); ...          // task data, before start()
+//     rt.start();
+//     TaskId t = rt.post(TaskOp::Axpy, n, a, b, c, 2.f);
+//     rt.wait(t);
+//
+// Descriptors (opcode, sizes, SVM pointers, completion flag) live in a
+// fine-grain SVM array with atomics; post() fills one, then pushes its index
+// into an Mpmc SvmRing. Each work-group of the persistent kernel pops an
+// index with its first work-item, runs the task with the whole group, and
+// releases the task's `done` flag, which wait() spins on. Task data is
+// fine-grain SVM registered with CL_KERNEL_EXEC_INFO_SVM_PTRS, so the host
+// reads and writes it directly while the kernel runs.
+//
+// Without fine-grain SVM atomics the same API falls back to one launch per
+// task on coarse-grain SVM (events instead of flags, clEnqueueSVMMemcpy for
+// data); the task code is shared by both paths.
+//
+// post() and wait() may be called from several host threads. The persistent
+// path only needs the Mpmc push; the launch path serializes setArg and
+// enqueue on the one shared kernel.
+
+#include "svm_common.h"
+#include "svm_ring.h"
+
+#include <memory>
+#include <mutex>
+
+static const char* taskSource = R"(
+#define STOP_TASK 0xffffffffu
+
+enum { OP_NOP = 0, OP_FILL = 1, OP_SCALE = 2, OP_AXPY = 3 };
+
+typedef struct {
+    uint op;
+    uint n;
+    float alpha;
+    uint pad0;
+    __global float* a;
+    __global float* b;
+    __global float* c;
+    atomic_uint done;
+    uint pad1[5];
+} Task;
+
+// elements first, first + stride, ... of one task
+void taskBody(uint op, uint n, float alpha, __global const float* a, __global const float* b, __global float* c,
+              uint first, uint stride)
+{
+    for (uint i = first; i < n; i += stride) {
+        if (op == OP_FILL)
+            c[i] = alpha;
+        else if (op == OP_SCALE)
+            c[i] = alpha * a[i];
+        else if (op == OP_AXPY)
+            c[i] = alpha * a[i] + b[i];
+    }
+}
+
+__kernel void launchTask(uint op, uint n, float alpha, __global const float* a, __global const float* b,
+                         __global float* c)
+{
+    taskBody(op, n, alpha, a, b, c, get_global_id(0), get_global_size(0));
+}
+
+#ifdef PERSISTENT
+__kernel void persistent(__global RingHeader* qH, __global RingSlot* qSlots, __global Task* tasks)
+{
+    __local uint current;
+    uint lid = get_local_id(0);
+    for (;;) {
+        if (lid == 0) {
+            ulong v;
+            while (!ringPop(qH, qSlots, &v))
+                ;
+            current = (uint)v;
+        }
+        work_group_barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);
+        uint t = current;
+        if (t == STOP_TASK)
+            break;
+        __global Task* task = &tasks[t];
+        taskBody(task->op, task->n, task->alpha, task->a, task->b, task->c, lid, get_local_size(0));
+        // the whole group's writes before the flag, and `current` is free again
+        work_group_barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE, memory_scope_all_svm_devices);
+        if (lid == 0)
+            atomic_store_explicit(&task->done, 1, memory_order_release, memory_scope_all_svm_devices);
+    }
+}
+#endif
+)";
+
+enum class TaskOp : uint32_t { Nop = 0, Fill = 1, Scale = 2, Axpy = 3 };
+
+typedef uint32_t TaskId;
+
+// host mirror of Task
+struct SvmTask {
+    uint32_t op;
+    uint32_t n;
+    float alpha;
+    uint32_t pad0;
+    const float* a;
+    const float* b;
+    float* c;
+    std::atomic<uint32_t> done;
+    uint32_t pad1[5];
+};
+static_assert(sizeof(SvmTask) == 64, "SvmTask must match Task");
+
+class TaskRuntime {
+public:
+    static const uint32_t STOP_TASK = 0xffffffffu;
+
+    // groups = 0: one work-group per compute unit
+    TaskRuntime(OclEnv& env, bool allowPersistent = true, uint32_t maxTasks = 1024, size_t groups = 0,
+                size_t localSize = 64)
+        : env_(env), maxTasks_(maxTasks), localSize_(localSize) {
+        persistent_ = allowPersistent && svmFineGrainBuffer(env) && svmAtomics(env) &&
+                      env.device.getInfo<CL_DEVICE_ADDRESS_BITS>() == 64;
+        if (!persistent_ && !env.svm())
+            throw std::runtime_error("TaskRuntime needs at least coarse-grain SVM");
+        groups_ = groups ? groups : env.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+
+        std::string src = taskSource;
+        std::string opts = "-cl-std=CL2.0";
+        if (persistent_) {
+            src = std::string(svmRingSource) + taskSource;
+            opts = ringOptions(RingKind::Mpmc) + " -D PERSISTENT";
+        }
+        program_ = buildProgram(env, src, opts);
+        launch_ = cl::Kernel(program_, "launchTask");
+
+        for (uint32_t i = maxTasks; i-- > 0;)
+            free_.push_back(i);
+        if (persistent_) {
+            tasks_ = SvmAlloc(env, maxTasks * sizeof(SvmTask),
+                              CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS);
+            for (uint32_t i = 0; i < maxTasks; ++i)
+                new (&tasks_.as<SvmTask>()[i]) SvmTask();
+            queue_.reset(new SvmRing(env, maxTasks + (uint32_t)groups_, RingKind::Mpmc));
+            persistentQueue_ = cl::CommandQueue(env.context, env.device);
+        } else {
+            events_.resize(maxTasks);
+        }
+    }
+    TaskRuntime(const TaskRuntime&) = delete;
+    TaskRuntime& operator=(const TaskRuntime&) = delete;
+
+    ~TaskRuntime() {
+        try {
+            stop();
+        } catch (const std::exception& ex) {
+            std::cerr << "Error: " << ex.what() << std::endl;
+        }
+    }
+
+    bool persistent() const { return persistent_; }
+    const char* modeName() const { return persistent_ ? "persistent" : "launch"; }
+
+    // task data: fine-grain SVM in persistent mode, coarse-grain otherwise
+    float* alloc(size_t n) {
+        if (running_)
+            throw std::runtime_error("TaskRuntime::alloc after start()");
+        cl_svm_mem_flags flags = CL_MEM_READ_WRITE | (persistent_ ? CL_MEM_SVM_FINE_GRAIN_BUFFER : 0);
+        data_.emplace_back(env_, std::max<size_t>(n, 1) * sizeof(float), flags);
+        return data_.back().as<float>();
+    }
+
+    void write(float* dst, const float* src, size_t n) {
+        if (persistent_)
+            memcpy(dst, src, n * sizeof(float));
+        else
+            svmCopy(dst, src, n * sizeof(float));
+    }
+    void read(float* dst, const float* src, size_t n) {
+        if (persistent_)
+            memcpy(dst, src, n * sizeof(float));
+        else
+            svmCopy(dst, src, n * sizeof(float));
+    }
+
+    // launches the persistent kernel; nothing to do in launch mode
+    void start() {
+        if (running_)
+            return;
+        running_ = true;
+        if (!persistent_)
+            return;
+        persistentKernel_ = cl::Kernel(program_, "persistent");
+        queue_->setArgs(persistentKernel_, 0);
+        setSvmArg(persistentKernel_, 2, tasks_.get());
+        std::vector<void*> ptrs;
+        for (auto& d : data_)
+            ptrs.push_back(d.get());
+        if (!ptrs.empty()) {
+            cl_int err = clSetKernelExecInfo(persistentKernel_(), CL_KERNEL_EXEC_INFO_SVM_PTRS,
+                                             ptrs.size() * sizeof(void*), ptrs.data());
+            if (err != CL_SUCCESS)
+                throw std::runtime_error("clSetKernelExecInfo failed: " + std::to_string(err));
+        }
+        persistentQueue_.enqueueNDRangeKernel(persistentKernel_, cl::NullRange, cl::NDRange(groups_ * localSize_),
+                                              cl::NDRange(localSize_));
+        persistentQueue_.flush();
+    }
+
+    TaskId post(TaskOp op, uint32_t n, const float* a, const float* b, float* c, float alpha = 0.f) {
+        if (!running_)
+            throw std::runtime_error("TaskRuntime::post before start()");
+        TaskId id;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (free_.empty())
+                throw std::runtime_error("TaskRuntime: more than " + std::to_string(maxTasks_) + " tasks in flight");
+            id = free_.back();
+            free_.pop_back();
+        }
+
+        if (persistent_) {
+            SvmTask& t = tasks_.as<SvmTask>()[id];
+            t.op = (uint32_t)op;
+            t.n = n;
+            t.alpha = alpha;
+            t.a = a;
+            t.b = b;
+            t.c = c;
+            t.done.store(0, std::memory_order_relaxed);
+            if (!queue_->push(id))
+                throw std::runtime_error("TaskRuntime: persistent kernel not draining the queue");
+            return id;
+        }
+
+        // launch_ is shared: its arguments stay ours until the enqueue
+        std::lock_guard<std::mutex> lock(mutex_);
+        cl::Kernel& k = launch_;
+        k.setArg(0, (cl_uint)op);
+        k.setArg(1, (cl_uint)n);
+        k.setArg(2, alpha);
+        setSvmArg(k, 3, a);
+        setSvmArg(k, 4, b);
+        setSvmArg(k, 5, c);
+        size_t global = std::max<size_t>((n + localSize_ - 1) / localSize_ * localSize_, localSize_);
+        env_.queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(global), cl::NDRange(localSize_), nullptr,
+                                        &events_[id]);
+        env_.queue.flush();
+        return id;
+    }
+
+    bool done(TaskId id) {
+        if (persistent_)
+            return tasks_.as<SvmTask>()[id].done.load(std::memory_order_acquire) != 0;
+        return events_[id].getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>() == CL_COMPLETE;
+    }
+
+    void wait(TaskId id) {
+        if (persistent_) {
+            std::atomic<uint32_t>& flag = tasks_.as<SvmTask>()[id].done;
+            auto t0 = std::chrono::high_resolution_clock::now();
+            for (uint32_t spins = 0; flag.load(std::memory_order_acquire) == 0; ++spins)
+                if ((spins & 1023) == 1023) {
+                    if (secondsSince(t0) > 5.0)
+                        throw std::runtime_error("TaskRuntime: task " + std::to_string(id) + " did not complete");
+                    std::this_thread::yield();
+                }
+        } else {
+            events_[id].wait();
+            events_[id] = cl::Event();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(id);
+    }
+
+    // all posted tasks finish first; the kernel then exits
+    void stop() {
+        if (!running_)
+            return;
+        running_ = false;
+        if (persistent_) {
+            for (size_t g = 0; g < groups_; ++g)
+                queue_->push(STOP_TASK);
+            persistentQueue_.finish();
+        } else {
+            env_.queue.finish();
+        }
+    }
+
+private:
+    void svmCopy(void* dst, const void* src, size_t bytes) {
+        cl_int err = clEnqueueSVMMemcpy(env_.queue(), CL_TRUE, dst, src, bytes, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("clEnqueueSVMMemcpy failed: " + std::to_string(err));
+    }
+
+    OclEnv& env_;
+    uint32_t maxTasks_;
+    size_t localSize_;
+    size_t groups_ = 0;
+    bool persistent_ = false;
+    bool running_ = false;
+
+    cl::Program program_;
+    cl::Kernel launch_;
+    cl::Kernel persistentKernel_;
+    cl::CommandQueue persistentQueue_;
+    std::unique_ptr<SvmRing> queue_;
+    SvmAlloc tasks_;
+    std::vector<SvmAlloc> data_;
+    std::vector<cl::Event> events_;
+    std::vector<TaskId> free_;
+    std::mutex mutex_;
+};
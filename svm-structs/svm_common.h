@@ -0,0 +1,113 @@
+#pragma once
+
+// SVM helpers shared by the svm-structs tests: capability checks and an owning
+// SVM allocation. Fine-grain allocations with CL_MEM_SVM_ATOMICS can be
+// updated concurrently by host (std::atomic) and device (OpenCL 2.0 atomics
+// with memory_scope_all_svm_devices) while a kernel is running.
+
+#include "../primitives/ocl_env.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+static bool svmFineGrainBuffer(const OclEnv& env) { return (env.svmCaps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) != 0; }
+static bool svmFineGrainSystem(const OclEnv& env) { return (env.svmCaps & CL_DEVICE_SVM_FINE_GRAIN_SYSTEM) != 0; }
+static bool svmAtomics(const OclEnv& env) { return (env.svmCaps & CL_DEVICE_SVM_ATOMICS) != 0; }
+
+static void printSvmCaps(const OclEnv& env) {
+    std::cout << "SVM:"
+              << ((env.svmCaps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER) ? " coarse-grain-buffer" : "")
+              << (svmFineGrainBuffer(env) ? " fine-grain-buffer" : "")
+              << (svmFineGrainSystem(env) ? " fine-grain-system" : "")
+              << (svmAtomics(env) ? " atomics" : "")
+              << (env.svmCaps == 0 ? " none" : "") << std::endl;
+}
+
+// the host side of a device atomic_uint living in fine-grain SVM
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "atomic<uint32_t> must match atomic_uint");
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "atomic<uint64_t> must match atomic_ulong");
+
+// owning clSVMAlloc allocation; coarse-grain unless flags say otherwise
+class SvmAlloc {
+public:
+    SvmAlloc() {}
+    SvmAlloc(OclEnv& env, size_t bytes, cl_svm_mem_flags flags = CL_MEM_READ_WRITE) : env_(&env), bytes_(bytes) {
+        ptr_ = clSVMAlloc(env.context(), flags, bytes, 0);
+        if (!ptr_)
+            throw std::runtime_error("clSVMAlloc failed (" + std::to_string(bytes) + " bytes)");
+    }
+    SvmAlloc(const SvmAlloc&) = delete;
+    SvmAlloc& operator=(const SvmAlloc&) = delete;
+    SvmAlloc(SvmAlloc&& o) noexcept { *this = std::move(o); }
+    SvmAlloc& operator=(SvmAlloc&& o) noexcept {
+        std::swap(env_, o.env_);
+        std::swap(ptr_, o.ptr_);
+        std::swap(bytes_, o.bytes_);
+        return *this;
+    }
+    ~SvmAlloc() {
+        if (ptr_) clSVMFree(env_->context(), ptr_);
+    }
+
+    void* get() const { return ptr_; }
+    template <typename T> T* as() const { return static_cast<T*>(ptr_); }
+    size_t bytes() const { return bytes_; }
+
+private:
+    OclEnv* env_ = nullptr;
+    void* ptr_ = nullptr;
+    size_t bytes_ = 0;
+};
+
+static void setSvmArg(cl::Kernel& kernel, cl_uint index, const void* ptr) {
+    cl_int err = clSetKernelArgSVMPointer(kernel(), index, ptr);
+    if (err != CL_SUCCESS)
+        throw std::runtime_error("clSetKernelArgSVMPointer failed: " + std::to_string(err));
+}
+
+static void svmMemcpy(OclEnv& env, void* dst, const void* src, size_t bytes) {
+    cl_int err = clEnqueueSVMMemcpy(env.queue(), CL_TRUE, dst, src, bytes, 0, nullptr, nullptr);
+    if (err != CL_SUCCESS)
+        throw std::runtime_error("clEnqueueSVMMemcpy failed: " + std::to_string(err));
+}
+
+// host access to an SVM range for the lifetime of the object: map/unmap for
+// coarse-grain allocations, nothing for fine-grain ones
+class SvmHostAccess {
+public:
+    SvmHostAccess(OclEnv& env, void* ptr, size_t bytes, bool fineGrain) : env_(env), ptr_(fineGrain ? nullptr : ptr) {
+        if (!ptr_)
+            return;
+        cl_int err = clEnqueueSVMMap(env.queue(), CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, ptr_, bytes, 0, nullptr, nullptr);
+        if (err != CL_SUCCESS)
+            throw std::runtime_error("clEnqueueSVMMap failed: " + std::to_string(err));
+    }
+    SvmHostAccess(const SvmHostAccess&) = delete;
+    SvmHostAccess& operator=(const SvmHostAccess&) = delete;
+    ~SvmHostAccess() {
+        if (!ptr_)
+            return;
+        clEnqueueSVMUnmap(env_.queue(), ptr_, 0, nullptr, nullptr);
+        env_.queue.finish();
+    }
+
+private:
+    OclEnv& env_;
+    void* ptr_;
+};
+
+static double secondsSince(std::chrono::high_resolution_clock::time_point t0) {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+// p in (0, 1], nearest-rank: the smallest sample with at least p * n samples
+// at or below it
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty())
+        return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t rank = (size_t)std::ceil(p * v.size());
+    return v[std::min(std::max<size_t>(rank, 1), v.size()) - 1];
+}
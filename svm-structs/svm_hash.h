@@ -0,0 +1,226 @@
+#pragma once
+
+// Open-addressing hash table (uint32 key -> uint32 value, linear probing)
+// whose storage is one SVM allocation, so host and kernels work on the same
+// slots through the same pointer: the host can build or update the table and
+// a kernel probe it, or a kernel insert a batch and the host probe the
+// result, with no serialization in between.
+//
+// Layout: 16 header words (entry count, failed inserts), then `capacity`
+// slots of {key, value}; key 0xffffffff marks an empty slot and cannot be
+// stored: inserting it counts as a failed insert. Device inserts claim a slot with atomic_cmpxchg on the key word;
+// a key inserted twice in one batch keeps one of the values. There is no
+// erase. Keep the load factor at or below ~0.5.
+//
+// The allocation is fine-grain buffer SVM when available; otherwise it is
+// coarse-grain and the host-side batches map and unmap it around their work.
+// Host and device batches do not overlap: every device call finishes before
+// it returns.
+
+#include "svm_common.h"
+
+static const char* svmHashSource = R"(
+#define EMPTY_KEY 0xffffffffu
+
+uint hashKey(uint k)
+{
+    k ^= k >> 16;
+    k *= 0x85ebca6bu;
+    k ^= k >> 13;
+    k *= 0xc2b2ae35u;
+    k ^= k >> 16;
+    return k;
+}
+
+// header[0]: entries, header[1]: inserts that found no free slot or used
+// the reserved EMPTY_KEY
+__kernel void hashInsert(__global uint* header, __global uint* slots, uint mask,
+                         __global const uint* keys, __global const uint* values, uint n)
+{
+    uint i = get_global_id(0);
+    if (i >= n)
+        return;
+    uint k = keys[i];
+    if (k == EMPTY_KEY) {
+        atomic_inc(&header[1]);
+        return;
+    }
+    uint h = hashKey(k) & mask;
+    for (uint probe = 0; probe <= mask; ++probe) {
+        uint prev = atomic_cmpxchg((volatile __global uint*)&slots[2 * h], EMPTY_KEY, k);
+        if (prev == EMPTY_KEY || prev == k) {
+            slots[2 * h + 1] = values[i];
+            if (prev == EMPTY_KEY)
+                atomic_inc(&header[0]);
+            return;
+        }
+        h = (h + 1) & mask;
+    }
+    atomic_inc(&header[1]);
+}
+
+__kernel void hashLookup(__global const uint* slots, uint mask, __global const uint* keys,
+                         __global uint* out, uint n, uint missing)
+{
+    uint i = get_global_id(0);
+    if (i >= n)
+        return;
+    uint k = keys[i];
+    uint h = hashKey(k) & mask;
+    uint v = missing;
+    for (uint probe = 0; probe <= mask; ++probe) {
+        uint key = slots[2 * h];
+        if (key == k) {
+            v = slots[2 * h + 1];
+            break;
+        }
+        if (key == EMPTY_KEY)
+            break;
+        h = (h + 1) & mask;
+    }
+    out[i] = v;
+}
+)";
+
+class SvmHashTable {
+public:
+    static const uint32_t EMPTY_KEY = 0xffffffffu;
+    static const uint32_t HEADER_WORDS = 16;
+
+    // capacity is rounded up to a power of two
+    SvmHashTable(OclEnv& env, uint32_t capacity) : env_(env) {
+        if (!env.svm())
+            throw std::runtime_error("SvmHashTable needs SVM");
+        capacity_ = 2;
+        while (capacity_ < capacity)
+            capacity_ <<= 1;
+        fineGrain_ = svmFineGrainBuffer(env);
+        mem_ = SvmAlloc(env, bytes(), CL_MEM_READ_WRITE | (fineGrain_ ? CL_MEM_SVM_FINE_GRAIN_BUFFER : 0));
+
+        program_ = buildProgram(env, svmHashSource, "-cl-std=CL2.0");
+        insert_ = cl::Kernel(program_, "hashInsert");
+        lookup_ = cl::Kernel(program_, "hashLookup");
+        clear();
+    }
+
+    uint32_t capacity() const { return capacity_; }
+    bool fineGrain() const { return fineGrain_; }
+    size_t bytes() const { return (HEADER_WORDS + 2 * (size_t)capacity_) * sizeof(uint32_t); }
+    // the SVM pointer kernels can be given directly
+    uint32_t* data() const { return mem_.as<uint32_t>(); }
+
+    uint32_t size() {
+        SvmHostAccess access(env_, mem_.get(), HEADER_WORDS * sizeof(uint32_t), fineGrain_);
+        return header()[0];
+    }
+    uint32_t failedInserts() {
+        SvmHostAccess access(env_, mem_.get(), HEADER_WORDS * sizeof(uint32_t), fineGrain_);
+        return header()[1];
+    }
+
+    void clear() {
+        SvmHostAccess access(env_, mem_.get(), bytes(), fineGrain_);
+        std::fill(header(), header() + HEADER_WORDS, 0u);
+        std::fill(slots(), slots() + 2 * (size_t)capacity_, EMPTY_KEY);
+    }
+
+    // host batches; return the number of inserts that found no free slot or
+    // used the reserved EMPTY_KEY
+    uint32_t insertHost(const uint32_t* keys, const uint32_t* values, size_t n) {
+        SvmHostAccess access(env_, mem_.get(), bytes(), fineGrain_);
+        uint32_t* s = slots();
+        uint32_t mask = capacity_ - 1, failed = 0;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t k = keys[i], h = hashKey(k) & mask, probe = 0;
+            if (k == EMPTY_KEY) {
+                failed++;
+                continue;
+            }
+            for (; probe <= mask; ++probe, h = (h + 1) & mask) {
+                if (s[2 * h] == EMPTY_KEY) {
+                    s[2 * h] = k;
+                    header()[0]++;
+                    break;
+                }
+                if (s[2 * h] == k)
+                    break;
+            }
+            if (probe > mask) {
+                failed++;
+                continue;
+            }
+            s[2 * h + 1] = values[i];
+        }
+        header()[1] += failed;
+        return failed;
+    }
+
+    void lookupHost(const uint32_t* keys, uint32_t* out, size_t n, uint32_t missing = 0xffffffffu) {
+        SvmHostAccess access(env_, mem_.get(), bytes(), fineGrain_);
+        const uint32_t* s = slots();
+        uint32_t mask = capacity_ - 1;
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t k = keys[i], h = hashKey(k) & mask, v = missing;
+            for (uint32_t probe = 0; probe <= mask; ++probe, h = (h + 1) & mask) {
+                if (s[2 * h] == k) {
+                    v = s[2 * h + 1];
+                    break;
+                }
+                if (s[2 * h] == EMPTY_KEY)
+                    break;
+            }
+            out[i] = v;
+        }
+    }
+
+    // device batches; keys / values / out are SVM pointers
+    void insertDevice(const uint32_t* keys, const uint32_t* values, uint32_t n) {
+        setSvmArg(insert_, 0, header());
+        setSvmArg(insert_, 1, slots());
+        insert_.setArg(2, (cl_uint)(capacity_ - 1));
+        setSvmArg(insert_, 3, keys);
+        setSvmArg(insert_, 4, values);
+        insert_.setArg(5, (cl_uint)n);
+        run(insert_, n);
+    }
+
+    void lookupDevice(const uint32_t* keys, uint32_t* out, uint32_t n, uint32_t missing = 0xffffffffu) {
+        setSvmArg(lookup_, 0, slots());
+        lookup_.setArg(1, (cl_uint)(capacity_ - 1));
+        setSvmArg(lookup_, 2, keys);
+        setSvmArg(lookup_, 3, out);
+        lookup_.setArg(4, (cl_uint)n);
+        lookup_.setArg(5, (cl_uint)missing);
+        run(lookup_, n);
+    }
+
+    // same mix as hashKey on the device
+    static uint32_t hashKey(uint32_t k) {
+        k ^= k >> 16;
+        k *= 0x85ebca6bu;
+        k ^= k >> 13;
+        k *= 0xc2b2ae35u;
+        k ^= k >> 16;
+        return k;
+    }
+
+private:
+    uint32_t* header() const { return mem_.as<uint32_t>(); }
+    uint32_t* slots() const { return mem_.as<uint32_t>() + HEADER_WORDS; }
+
+    void run(cl::Kernel& kernel, uint32_t n) {
+        if (n == 0)
+            return;
+        size_t global = ((size_t)n + 255) / 256 * 256;
+        env_.queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(global), cl::NDRange(256));
+        env_.queue.finish();
+    }
+
+    OclEnv& env_;
+    uint32_t capacity_ = 0;
+    bool fineGrain_ = false;
+    SvmAlloc mem_;
+    cl::Program program_;
+    cl::Kernel insert_;
+    cl::Kernel lookup_;
+};
@@ -0,0 +1,288 @@
+#pragma once
+
+// Lock-free ring buffer of 64-bit messages in fine-grain SVM, shared by host
+// and a running kernel. Allocated with
+// CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS, so the host side uses
+// std::atomic and the device side OpenCL 2.0 atomics with
+// memory_scope_all_svm_devices on the same words, no map/unmap and no launch
+// per message.
+//
+//   Spsc  one producer, one consumer. head/tail counters only: the producer
+//         writes the slot, then publishes tail with release; the consumer
+//         acquires tail, reads the slot, releases head.
+//   Mpmc  any number of producers and consumers on either side (bounded
+//         queue with a sequence number per slot): a producer claims a
+//         position by CAS on tail, writes the value, then releases the slot
+//         sequence to pos + 1; a consumer claims by CAS on head and releases
+//         the sequence to pos + capacity, which frees the slot for the next
+//         lap.
+//
+// Device code: prepend svmRingSource to the kernel source, build with
+// -cl-std=CL2.0 (plus -D RING_MPMC for the Mpmc layout) and take the ring as
+// two arguments, `__global RingHeader*` and `__global RingSlot*`, set with
+// SvmRing::setArgs. ringPush / ringPop pick the variant.
+//
+// head and tail sit on separate 64-byte lines so producer and consumer do
+// not bounce one line between host and device.
+
+#include "svm_common.h"
+
+#include <new>
+
+static const char* svmRingSource = R"(
+#define SVM_SCOPE memory_scope_all_svm_devices
+
+typedef struct {
+    atomic_uint head;
+    uint pad0[15];
+    atomic_uint tail;
+    uint pad1[15];
+    uint capacity;
+    uint mask;
+    uint pad2[14];
+} RingHeader;
+
+typedef struct {
+    atomic_uint seq;
+    uint pad;
+    ulong value;
+} MpmcSlot;
+
+bool spscPush(__global RingHeader* h, __global ulong* slots, ulong v)
+{
+    uint tail = atomic_load_explicit(&h->tail, memory_order_relaxed, SVM_SCOPE);
+    uint head = atomic_load_explicit(&h->head, memory_order_acquire, SVM_SCOPE);
+    if (tail - head == h->capacity)
+        return false;
+    slots[tail & h->mask] = v;
+    atomic_store_explicit(&h->tail, tail + 1, memory_order_release, SVM_SCOPE);
+    return true;
+}
+
+bool spscPop(__global RingHeader* h, __global ulong* slots, ulong* v)
+{
+    uint head = atomic_load_explicit(&h->head, memory_order_relaxed, SVM_SCOPE);
+    uint tail = atomic_load_explicit(&h->tail, memory_order_acquire, SVM_SCOPE);
+    if (head == tail)
+        return false;
+    *v = slots[head & h->mask];
+    atomic_store_explicit(&h->head, head + 1, memory_order_release, SVM_SCOPE);
+    return true;
+}
+
+bool mpmcPush(__global RingHeader* h, __global MpmcSlot* slots, ulong v)
+{
+    uint pos = atomic_load_explicit(&h->tail, memory_order_relaxed, SVM_SCOPE);
+    for (;;) {
+        __global MpmcSlot* s = &slots[pos & h->mask];
+        uint seq = atomic_load_explicit(&s->seq, memory_order_acquire, SVM_SCOPE);
+        int dif = (int)(seq - pos);
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&h->tail, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed, SVM_SCOPE)) {
+                s->value = v;
+                atomic_store_explicit(&s->seq, pos + 1, memory_order_release, SVM_SCOPE);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false;   // full
+        } else {
+            pos = atomic_load_explicit(&h->tail, memory_order_relaxed, SVM_SCOPE);
+        }
+    }
+}
+
+bool mpmcPop(__global RingHeader* h, __global MpmcSlot* slots, ulong* v)
+{
+    uint pos = atomic_load_explicit(&h->head, memory_order_relaxed, SVM_SCOPE);
+    for (;;) {
+        __global MpmcSlot* s = &slots[pos & h->mask];
+        uint seq = atomic_load_explicit(&s->seq, memory_order_acquire, SVM_SCOPE);
+        int dif = (int)(seq - (pos + 1));
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&h->head, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed, SVM_SCOPE)) {
+                *v = s->value;
+                atomic_store_explicit(&s->seq, pos + h->capacity, memory_order_release, SVM_SCOPE);
+                return true;
+            }
+        } else if (dif < 0) {
+            return false;   // empty
+        } else {
+            pos = atomic_load_explicit(&h->head, memory_order_relaxed, SVM_SCOPE);
+        }
+    }
+}
+
+#ifdef RING_MPMC
+typedef MpmcSlot RingSlot;
+#define ringPush mpmcPush
+#define ringPop mpmcPop
+#else
+typedef ulong RingSlot;
+#define ringPush spscPush
+#define ringPop spscPop
+#endif
+)";
+
+enum class RingKind { Spsc, Mpmc };
+
+static const char* ringKindName(RingKind kind) { return kind == RingKind::Spsc ? "spsc" : "mpmc"; }
+
+// build options matching the ring layout
+static std::string ringOptions(RingKind kind) {
+    return kind == RingKind::Mpmc ? "-cl-std=CL2.0 -D RING_MPMC" : "-cl-std=CL2.0";
+}
+
+// host mirrors of RingHeader / MpmcSlot
+struct SvmRingHeader {
+    std::atomic<uint32_t> head;
+    uint32_t pad0[15];
+    std::atomic<uint32_t> tail;
+    uint32_t pad1[15];
+    uint32_t capacity;
+    uint32_t mask;
+    uint32_t pad2[14];
+};
+static_assert(sizeof(SvmRingHeader) == 192, "SvmRingHeader must match RingHeader");
+
+struct SvmMpmcSlot {
+    std::atomic<uint32_t> seq;
+    uint32_t pad;
+    uint64_t value;
+};
+static_assert(sizeof(SvmMpmcSlot) == 16, "SvmMpmcSlot must match MpmcSlot");
+
+class SvmRing {
+public:
+    // capacity is rounded up to a power of two
+    SvmRing(OclEnv& env, uint32_t capacity, RingKind kind) : kind_(kind) {
+        if (!svmFineGrainBuffer(env) || !svmAtomics(env))
+            throw std::runtime_error("SvmRing needs fine-grain buffer SVM with atomics");
+        uint32_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        size_t slotBytes = kind == RingKind::Mpmc ? sizeof(SvmMpmcSlot) : sizeof(uint64_t);
+        mem_ = SvmAlloc(env, sizeof(SvmRingHeader) + cap * slotBytes,
+                        CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER | CL_MEM_SVM_ATOMICS);
+
+        header_ = new (mem_.get()) SvmRingHeader();
+        header_->head.store(0, std::memory_order_relaxed);
+        header_->tail.store(0, std::memory_order_relaxed);
+        header_->capacity = cap;
+        header_->mask = cap - 1;
+        slots_ = mem_.as<char>() + sizeof(SvmRingHeader);
+        if (kind == RingKind::Mpmc) {
+            SvmMpmcSlot* s = mpmcSlots();
+            for (uint32_t i = 0; i < cap; ++i) {
+                new (&s[i]) SvmMpmcSlot();
+                s[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    RingKind kind() const { return kind_; }
+    uint32_t capacity() const { return header_->capacity; }
+    // approximate while both sides are running
+    uint32_t size() const {
+        return header_->tail.load(std::memory_order_acquire) - header_->head.load(std::memory_order_acquire);
+    }
+
+    bool tryPush(uint64_t v) {
+        SvmRingHeader* h = header_;
+        if (kind_ == RingKind::Spsc) {
+            uint32_t tail = h->tail.load(std::memory_order_relaxed);
+            uint32_t head = h->head.load(std::memory_order_acquire);
+            if (tail - head == h->capacity)
+                return false;
+            spscSlots()[tail & h->mask] = v;
+            h->tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+        uint32_t pos = h->tail.load(std::memory_order_relaxed);
+        for (;;) {
+            SvmMpmcSlot& s = mpmcSlots()[pos & h->mask];
+            uint32_t seq = s.seq.load(std::memory_order_acquire);
+            int32_t dif = (int32_t)(seq - pos);
+            if (dif == 0) {
+                if (h->tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    s.value = v;
+                    s.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = h->tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool tryPop(uint64_t& v) {
+        SvmRingHeader* h = header_;
+        if (kind_ == RingKind::Spsc) {
+            uint32_t head = h->head.load(std::memory_order_relaxed);
+            uint32_t tail = h->tail.load(std::memory_order_acquire);
+            if (head == tail)
+                return false;
+            v = spscSlots()[head & h->mask];
+            h->head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+        uint32_t pos = h->head.load(std::memory_order_relaxed);
+        for (;;) {
+            SvmMpmcSlot& s = mpmcSlots()[pos & h->mask];
+            uint32_t seq = s.seq.load(std::memory_order_acquire);
+            int32_t dif = (int32_t)(seq - (pos + 1));
+            if (dif == 0) {
+                if (h->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    v = s.value;
+                    s.seq.store(pos + h->capacity, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = h->head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // spin, then yield; false if the other side made no room within timeout
+    bool push(uint64_t v, double timeoutSeconds = 5.0) {
+        return spinUntil([&] { return tryPush(v); }, timeoutSeconds);
+    }
+    bool pop(uint64_t& v, double timeoutSeconds = 5.0) {
+        return spinUntil([&] { return tryPop(v); }, timeoutSeconds);
+    }
+
+    // header and slots as two consecutive kernel arguments
+    void setArgs(cl::Kernel& kernel, cl_uint index) const {
+        setSvmArg(kernel, index, header_);
+        setSvmArg(kernel, index + 1, slots_);
+    }
+
+private:
+    uint64_t* spscSlots() { return reinterpret_cast<uint64_t*>(slots_); }
+    SvmMpmcSlot* mpmcSlots() { return reinterpret_cast<SvmMpmcSlot*>(slots_); }
+
+    template <typename F>
+    static bool spinUntil(F&& tryOnce, double timeoutSeconds) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        for (uint32_t spins = 0;; ++spins) {
+            if (tryOnce())
+                return true;
+            if ((spins & 1023) == 1023) {
+                if (secondsSince(t0) > timeoutSeconds)
+                    return false;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    RingKind kind_;
+    SvmAlloc mem_;
+    SvmRingHeader* header_ = nullptr;
+    char* slots_ = nullptr;
+};
@@ -0,0 +1,274 @@
+#pragma once
+
+// Sparse matrix stored in SVM: CSR (row pointers, column indices, values)
+// always, plus an ELL copy when padding is cheap. Both are plain SVM arrays,
+// so host code can read or patch them through the same pointers the kernels
+// use (fine-grain buffer SVM when available, SvmHostAccess otherwise).
+//
+// SpMV kernels:
+//   scalar  one work-item per CSR row; good for short, even rows
+//   vector  `vec` work-items per CSR row with a local-memory tree sum; good
+//           for long rows, vec follows the mean row length
+//   ell     one work-item per row over column-major padded ELL, coalesced
+//           loads and no row-pointer indirection; good for near-uniform rows
+// SparseMatVec::choose picks one from the row-length statistics taken when
+// the matrix is built. SpMM (CSR times a dense row-major k-column block) runs
+// one work-item per output element, neighbours sharing a row of A.
+
+#include "svm_common.h"
+
+#include <cmath>
+
+static const char* svmSparseSource = R"(
+__kernel void spmvScalar(uint rows, __global const uint* rowPtr, __global const uint* col,
+                         __global const float* val, __global const float* x, __global float* y)
+{
+    uint r = get_global_id(0);
+    if (r >= rows)
+        return;
+    float s = 0.f;
+    for (uint j = rowPtr[r]; j < rowPtr[r + 1]; ++j)
+        s += val[j] * x[col[j]];
+    y[r] = s;
+}
+
+// local size must be a multiple of vec, vec a power of two
+__kernel void spmvVector(uint rows, __global const uint* rowPtr, __global const uint* col,
+                         __global const float* val, __global const float* x, __global float* y,
+                         uint vec, __local float* partial)
+{
+    uint lid = get_local_id(0);
+    uint lane = lid & (vec - 1);
+    uint r = get_global_id(0) / vec;
+    float s = 0.f;
+    if (r < rows) {
+        uint end = rowPtr[r + 1];
+        for (uint j = rowPtr[r] + lane; j < end; j += vec)
+            s += val[j] * x[col[j]];
+    }
+    partial[lid] = s;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (uint off = vec >> 1; off > 0; off >>= 1) {
+        if (lane < off)
+            partial[lid] += partial[lid + off];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (lane == 0 && r < rows)
+        y[r] = partial[lid];
+}
+
+// column-major: entry k of row r at k * rows + r; padding has val 0, col 0
+__kernel void spmvEll(uint rows, uint width, __global const uint* col, __global const float* val,
+                      __global const float* x, __global float* y)
+{
+    uint r = get_global_id(0);
+    if (r >= rows)
+        return;
+    float s = 0.f;
+    for (uint k = 0; k < width; ++k) {
+        size_t i = (size_t)k * rows + r;
+        s += val[i] * x[col[i]];
+    }
+    y[r] = s;
+}
+
+// C (rows x k) = A (CSR) * B (cols x k), both dense row-major
+__kernel void spmmCsr(uint rows, uint k, __global const uint* rowPtr, __global const uint* col,
+                      __global const float* val, __global const float* B, __global float* C)
+{
+    uint j = get_global_id(0);
+    uint r = get_global_id(1);
+    if (j >= k || r >= rows)
+        return;
+    float s = 0.f;
+    for (uint i = rowPtr[r]; i < rowPtr[r + 1]; ++i)
+        s += val[i] * B[(size_t)col[i] * k + j];
+    C[(size_t)r * k + j] = s;
+}
+)";
+
+struct RowStats {
+    double mean = 0.0;
+    double stddev = 0.0;
+    uint32_t max = 0;
+};
+
+class SvmCsr {
+public:
+    // ELL is kept when its padded size is at most maxEllPadding * nnz
+    SvmCsr(OclEnv& env, uint32_t rows, uint32_t cols, const std::vector<uint32_t>& rowPtr,
+           const std::vector<uint32_t>& col, const std::vector<float>& val, double maxEllPadding = 1.5)
+        : env_(env), rows_(rows), cols_(cols), nnz_(rowPtr.at(rows)) {
+        if (col.size() < nnz_ || val.size() < nnz_)
+            throw std::runtime_error("SvmCsr: column / value arrays shorter than nnz");
+        fineGrain_ = svmFineGrainBuffer(env);
+
+        double sum = 0.0, sum2 = 0.0;
+        for (uint32_t r = 0; r < rows; ++r) {
+            uint32_t len = rowPtr[r + 1] - rowPtr[r];
+            sum += len;
+            sum2 += (double)len * len;
+            stats_.max = std::max(stats_.max, len);
+        }
+        stats_.mean = rows ? sum / rows : 0.0;
+        stats_.stddev = rows ? std::sqrt(std::max(0.0, sum2 / rows - stats_.mean * stats_.mean)) : 0.0;
+
+        rowPtr_ = upload(rowPtr.data(), (rows + 1) * sizeof(uint32_t));
+        col_ = upload(col.data(), nnz_ * sizeof(uint32_t));
+        val_ = upload(val.data(), nnz_ * sizeof(float));
+
+        size_t padded = (size_t)stats_.max * rows;
+        if (rows && padded <= maxEllPadding * std::max<size_t>(nnz_, 1)) {
+            ellWidth_ = stats_.max;
+            std::vector<uint32_t> ellCol(padded, 0);
+            std::vector<float> ellVal(padded, 0.f);
+            for (uint32_t r = 0; r < rows; ++r)
+                for (uint32_t j = rowPtr[r], k = 0; j < rowPtr[r + 1]; ++j, ++k) {
+                    ellCol[(size_t)k * rows + r] = col[j];
+                    ellVal[(size_t)k * rows + r] = val[j];
+                }
+            ellCol_ = upload(ellCol.data(), padded * sizeof(uint32_t));
+            ellVal_ = upload(ellVal.data(), padded * sizeof(float));
+        }
+    }
+
+    uint32_t rows() const { return rows_; }
+    uint32_t cols() const { return cols_; }
+    size_t nnz() const { return nnz_; }
+    const RowStats& stats() const { return stats_; }
+    bool fineGrain() const { return fineGrain_; }
+
+    // SVM arrays, usable by host code (through SvmHostAccess if coarse-grain)
+    uint32_t* rowPtr() const { return rowPtr_.as<uint32_t>(); }
+    uint32_t* col() const { return col_.as<uint32_t>(); }
+    float* val() const { return val_.as<float>(); }
+
+    bool hasEll() const { return ellWidth_ > 0; }
+    uint32_t ellWidth() const { return ellWidth_; }
+    uint32_t* ellCol() const { return ellCol_.as<uint32_t>(); }
+    float* ellVal() const { return ellVal_.as<float>(); }
+
+private:
+    SvmAlloc upload(const void* src, size_t bytes) {
+        SvmAlloc a(env_, std::max<size_t>(bytes, 4), CL_MEM_READ_WRITE | (fineGrain_ ? CL_MEM_SVM_FINE_GRAIN_BUFFER : 0));
+        if (bytes)
+            svmMemcpy(env_, a.get(), src, bytes);
+        return a;
+    }
+
+    OclEnv& env_;
+    uint32_t rows_, cols_;
+    size_t nnz_;
+    bool fineGrain_ = false;
+    RowStats stats_;
+    SvmAlloc rowPtr_, col_, val_;
+    uint32_t ellWidth_ = 0;
+    SvmAlloc ellCol_, ellVal_;
+};
+
+enum class SpmvKind { Auto, Scalar, Vector, Ell };
+
+static const char* spmvKindName(SpmvKind kind) {
+    switch (kind) {
+    case SpmvKind::Scalar: return "scalar";
+    case SpmvKind::Vector: return "vector";
+    case SpmvKind::Ell: return "ell";
+    default: return "auto";
+    }
+}
+
+class SparseMatVec {
+public:
+    static const size_t LOCAL = 128;
+
+    explicit SparseMatVec(OclEnv& env) : env_(env) {
+        program_ = buildProgram(env, svmSparseSource, "-cl-std=CL2.0");
+        scalar_ = cl::Kernel(program_, "spmvScalar");
+        vector_ = cl::Kernel(program_, "spmvVector");
+        ell_ = cl::Kernel(program_, "spmvEll");
+        spmm_ = cl::Kernel(program_, "spmmCsr");
+    }
+
+    // ELL when it exists (padding was cheap), vector-per-row when rows are
+    // long enough to fill the lanes, scalar otherwise
+    static SpmvKind choose(const SvmCsr& A) {
+        if (A.hasEll())
+            return SpmvKind::Ell;
+        if (A.stats().mean >= 8.0 || A.stats().stddev >= 4.0 * A.stats().mean)
+            return SpmvKind::Vector;
+        return SpmvKind::Scalar;
+    }
+
+    // lanes per row for the vector kernel: next power of two over the mean, 2..32
+    static uint32_t vectorWidth(const SvmCsr& A) {
+        uint32_t vec = 2;
+        while (vec < 32 && vec < A.stats().mean)
+            vec <<= 1;
+        return vec;
+    }
+
+    // y = A x; x and y are SVM pointers. Returns the kernel that ran.
+    SpmvKind spmv(const SvmCsr& A, const float* x, float* y, SpmvKind kind = SpmvKind::Auto) {
+        if (kind == SpmvKind::Auto)
+            kind = choose(A);
+        if (kind == SpmvKind::Ell && !A.hasEll())
+            throw std::runtime_error("spmv: matrix has no ELL copy");
+        uint32_t rows = A.rows();
+        if (rows == 0)
+            return kind;
+
+        if (kind == SpmvKind::Scalar) {
+            scalar_.setArg(0, (cl_uint)rows);
+            setSvmArg(scalar_, 1, A.rowPtr());
+            setSvmArg(scalar_, 2, A.col());
+            setSvmArg(scalar_, 3, A.val());
+            setSvmArg(scalar_, 4, x);
+            setSvmArg(scalar_, 5, y);
+            enqueue(scalar_, rows);
+        } else if (kind == SpmvKind::Vector) {
+            uint32_t vec = vectorWidth(A);
+            vector_.setArg(0, (cl_uint)rows);
+            setSvmArg(vector_, 1, A.rowPtr());
+            setSvmArg(vector_, 2, A.col());
+            setSvmArg(vector_, 3, A.val());
+            setSvmArg(vector_, 4, x);
+            setSvmArg(vector_, 5, y);
+            vector_.setArg(6, (cl_uint)vec);
+            vector_.setArg(7, cl::Local(LOCAL * sizeof(float)));
+            enqueue(vector_, (size_t)rows * vec);
+        } else {
+            ell_.setArg(0, (cl_uint)rows);
+            ell_.setArg(1, (cl_uint)A.ellWidth());
+            setSvmArg(ell_, 2, A.ellCol());
+            setSvmArg(ell_, 3, A.ellVal());
+            setSvmArg(ell_, 4, x);
+            setSvmArg(ell_, 5, y);
+            enqueue(ell_, rows);
+        }
+        return kind;
+    }
+
+    // C = A B; B is cols x k, C rows x k, dense row-major SVM arrays
+    void spmm(const SvmCsr& A, const float* B, float* C, uint32_t k) {
+        if (A.rows() == 0 || k == 0)
+            return;
+        spmm_.setArg(0, (cl_uint)A.rows());
+        spmm_.setArg(1, (cl_uint)k);
+        setSvmArg(spmm_, 2, A.rowPtr());
+        setSvmArg(spmm_, 3, A.col());
+        setSvmArg(spmm_, 4, A.val());
+        setSvmArg(spmm_, 5, B);
+        setSvmArg(spmm_, 6, C);
+        env_.queue.enqueueNDRangeKernel(spmm_, cl::NullRange, cl::NDRange(k, A.rows()), cl::NullRange);
+    }
+
+private:
+    void enqueue(cl::Kernel& kernel, size_t items) {
+        size_t global = (items + LOCAL - 1) / LOCAL * LOCAL;
+        env_.queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(global), cl::NDRange(LOCAL));
+    }
+
+    OclEnv& env_;
+    cl::Program program_;
+    cl::Kernel scalar_, vector_, ell_, spmm_;
+};
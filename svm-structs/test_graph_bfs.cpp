@@ -0,0 +1,92 @@
+// BFS on a malloc-built pointer graph: traversed in place through fine-grain
+// system SVM, against flattening to CSR and uploading first (the fallback for
+// devices without system SVM). Levels are checked against a host BFS.
+//
+// usage: ./app [nodes] [avg_degree] [runs]
+
+#include "svm_common.h"
+#include "graph_bfs.h"
+
+#include <deque>
+#include <random>
+
+static std::vector<int32_t> hostBfs(const PointerGraph& g, uint32_t source) {
+    std::vector<int32_t> levels(g.size(), -1);
+    std::deque<const GraphNode*> queue;
+    levels[source] = 0;
+    queue.push_back(g.node(source));
+    while (!queue.empty()) {
+        const GraphNode* u = queue.front();
+        queue.pop_front();
+        for (uint32_t e = 0; e < u->degree; ++e) {
+            const GraphNode* v = u->neighbors[e];
+            if (levels[v->id] < 0) {
+                levels[v->id] = levels[u->id] + 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    return levels;
+}
+
+int main(int argc, char** argv) {
+    uint32_t nodes = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 1u << 20;
+    uint32_t degree = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 8;
+    int runs = argc > 3 ? atoi(argv[3]) : 5;
+
+    try {
+        OclEnv env = OclEnv::create();
+        printSvmCaps(env);
+
+        std::mt19937 rng(5);
+        PointerGraph g(nodes);
+        std::vector<uint32_t> adj;
+        size_t edges = 0;
+        for (uint32_t u = 0; u < nodes; ++u) {
+            adj.resize(rng() % (2 * degree + 1));
+            for (auto& v : adj)
+                v = rng() % nodes;
+            g.setNeighbors(u, adj);
+            edges += adj.size();
+        }
+        uint32_t source = 0;
+        std::vector<int32_t> ref = hostBfs(g, source);
+        int refLevels = *std::max_element(ref.begin(), ref.end()) + 1;
+        printf("graph: %u nodes, %zu edges, %d levels from node %u\n", nodes, edges, refLevels, source);
+        int failures = 0;
+
+        // fallback: serialize, upload, traverse indices
+        std::vector<uint32_t> rowPtr, col;
+        std::vector<int32_t> levels;
+        CsrBfs csr(env);
+        double tFlatten = timeRuns(env, runs, [&] { flattenToCsr(g, rowPtr, col); });
+        double tUpload = timeRuns(env, runs, [&] { csr.upload(rowPtr, col); });
+        int csrLevels = 0;
+        double tCsr = timeRuns(env, runs, [&] { csrLevels = csr.run(source, levels); });
+        bool ok = csrLevels == refLevels && levels == ref;
+        failures += ok ? 0 : 1;
+        double csrTotal = tFlatten + tUpload + tCsr;
+        printf("csr:        flatten %8.2f ms  upload %8.2f ms  bfs %8.2f ms  total %8.2f ms  (%.0f%% serialization)  %s\n",
+               tFlatten * 1e3, tUpload * 1e3, tCsr * 1e3, csrTotal * 1e3, 100.0 * (tFlatten + tUpload) / csrTotal,
+               ok ? "ok" : "MISMATCH");
+
+        if (!svmFineGrainSystem(env)) {
+            std::cout << "Device does not support fine-grain system SVM, pointer traversal skipped." << std::endl;
+            return failures == 0 ? 0 : 1;
+        }
+        SystemSvmBfs sys(env);
+        int sysLevels = 0;
+        double tSys = timeRuns(env, runs, [&] { sysLevels = sys.run(g, source); });
+        ok = sysLevels == refLevels;
+        for (uint32_t v = 0; ok && v < nodes; ++v)
+            ok = g.node(v)->level == ref[v];
+        failures += ok ? 0 : 1;
+        printf("system svm: bfs %8.2f ms, no serialization  (%.2fx vs csr total, %.2fx vs csr bfs only)  %s\n",
+               tSys * 1e3, csrTotal / tSys, tCsr / tSys, ok ? "ok" : "MISMATCH");
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
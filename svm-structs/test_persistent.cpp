@@ -0,0 +1,98 @@
+// Per-task cost of the persistent-kernel runtime against one launch per task,
+// through the same TaskRuntime API.
+//
+//   latency     post one task, wait for it, repeat (nop and axpy of `elems`)
+//   throughput  post `batch` tasks, then wait for all of them
+//
+// The axpy results are checked on the host. Without fine-grain SVM atomics
+// only the launch mode runs.
+//
+// usage: ./app [elems] [tasks] [batch]
+
+#include "svm_common.h"
+#include "persistent.h"
+
+#include <cmath>
+#include <cstdlib>
+
+static bool runMode(OclEnv& env, bool allowPersistent, uint32_t elems, int tasks, int batch) {
+    TaskRuntime rt(env, allowPersistent, (uint32_t)batch);
+    std::vector<float> ha(elems), hb(elems), hc(elems);
+    for (uint32_t i = 0; i < elems; ++i) {
+        ha[i] = (float)(i % 1000);
+        hb[i] = (float)(i % 7);
+    }
+    float* a = rt.alloc(elems);
+    float* b = rt.alloc(elems);
+    float* c = rt.alloc(elems);
+    rt.write(a, ha.data(), elems);
+    rt.write(b, hb.data(), elems);
+    rt.start();
+
+    // warm up
+    for (int i = 0; i < 16; ++i)
+        rt.wait(rt.post(TaskOp::Nop, 0, nullptr, nullptr, c));
+
+    std::vector<double> nop, axpy;
+    for (int i = 0; i < tasks; ++i) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        rt.wait(rt.post(TaskOp::Nop, 0, nullptr, nullptr, c));
+        nop.push_back(secondsSince(t0));
+    }
+    for (int i = 0; i < tasks; ++i) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        rt.wait(rt.post(TaskOp::Axpy, elems, a, b, c, 2.f));
+        axpy.push_back(secondsSince(t0));
+    }
+
+    std::vector<TaskId> ids;
+    int rounds = std::max(1, tasks / batch);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        ids.clear();
+        for (int i = 0; i < batch; ++i)
+            ids.push_back(rt.post(TaskOp::Axpy, elems, a, b, c, 2.f));
+        for (TaskId id : ids)
+            rt.wait(id);
+    }
+    double tBatch = secondsSince(t0);
+
+    rt.read(hc.data(), c, elems);
+    rt.stop();
+    int errors = 0;
+    for (uint32_t i = 0; i < elems; ++i)
+        if (std::fabs(hc[i] - (2.f * ha[i] + hb[i])) > 1e-4f)
+            errors++;
+
+    printf("%-10s nop %7.2f us (p99 %7.2f)  axpy %7.2f us (p99 %7.2f)  batched %8.0f tasks/s  %s\n", rt.modeName(),
+           percentile(nop, 0.5) * 1e6, percentile(nop, 0.99) * 1e6, percentile(axpy, 0.5) * 1e6,
+           percentile(axpy, 0.99) * 1e6, rounds * batch / tBatch, errors == 0 ? "ok" : "MISMATCH");
+    return errors == 0;
+}
+
+int main(int argc, char** argv) {
+    uint32_t elems = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 4096;
+    int tasks = argc > 2 ? atoi(argv[2]) : 10000;
+    int batch = argc > 3 ? atoi(argv[3]) : 256;
+
+    try {
+        OclEnv env = OclEnv::create();
+        printSvmCaps(env);
+        if (!env.svm()) {
+            std::cout << "Device does not support SVM." << std::endl;
+            return 1;
+        }
+        printf("elements per task: %u\n", elems);
+
+        bool ok = runMode(env, false, elems, tasks, batch);
+        if (svmFineGrainBuffer(env) && svmAtomics(env))
+            ok = runMode(env, true, elems, tasks, batch) && ok;
+        else
+            std::cout << "No fine-grain SVM atomics, persistent mode skipped." << std::endl;
+        return ok ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,126 @@
+// SVM hash table shared by host and kernels, no serialization in between:
+//
+//   host-built / device-probed    insertHost, then lookupDevice
+//   device-built / host-probed    insertDevice, then lookupHost
+//
+// Keys are distinct (i * 2654435761 is a bijection on uint32), lookups are
+// half hits and half guaranteed misses in shuffled order, values are checked.
+//
+// usage: ./app [entries] [lookups] [runs]
+
+#include "svm_common.h"
+#include "svm_hash.h"
+
+#include <cstdlib>
+#include <random>
+
+static uint32_t keyOf(uint32_t i) { return i * 2654435761u; }
+
+static int verify(const std::vector<uint32_t>& out, const std::vector<uint32_t>& expected) {
+    int errors = 0;
+    for (size_t i = 0; i < out.size(); ++i)
+        if (out[i] != expected[i])
+            errors++;
+    return errors;
+}
+
+int main(int argc, char** argv) {
+    uint32_t entries = argc > 1 ? (uint32_t)strtoul(argv[1], nullptr, 10) : 4u << 20;
+    uint32_t lookups = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10) : 16u << 20;
+    int runs = argc > 3 ? atoi(argv[3]) : 5;
+    const uint32_t MISSING = 0xffffffffu;
+
+    try {
+        OclEnv env = OclEnv::create();
+        printSvmCaps(env);
+        if (!env.svm()) {
+            std::cout << "Device does not support SVM." << std::endl;
+            return 1;
+        }
+
+        std::vector<uint32_t> keys(entries), values(entries);
+        for (uint32_t i = 0; i < entries; ++i) {
+            keys[i] = keyOf(i);
+            values[i] = i;
+        }
+        // key 0xffffffff is reserved; keyOf gives it only for i = 4050964655, past any index used here
+        std::vector<uint32_t> probe(lookups), expected(lookups), out(lookups);
+        std::mt19937 rng(11);
+        for (uint32_t i = 0; i < lookups; ++i) {
+            uint32_t j = rng() % entries;
+            bool hit = (i & 1) == 0;
+            probe[i] = hit ? keyOf(j) : keyOf(entries + j);
+            expected[i] = hit ? j : MISSING;
+        }
+
+        SvmHashTable table(env, entries * 2);
+        std::cout << "capacity " << table.capacity() << ", " << table.bytes() / (1024 * 1024) << " MB, "
+                  << (table.fineGrain() ? "fine-grain" : "coarse-grain") << " SVM" << std::endl;
+
+        // kernel-side arrays
+        SvmAlloc dKeys(env, entries * sizeof(uint32_t)), dValues(env, entries * sizeof(uint32_t));
+        SvmAlloc dProbe(env, lookups * sizeof(uint32_t)), dOut(env, lookups * sizeof(uint32_t));
+        svmMemcpy(env, dKeys.get(), keys.data(), entries * sizeof(uint32_t));
+        svmMemcpy(env, dValues.get(), values.data(), entries * sizeof(uint32_t));
+        svmMemcpy(env, dProbe.get(), probe.data(), lookups * sizeof(uint32_t));
+        int failures = 0;
+
+        // host-built / device-probed
+        double tHostBuild = timeRuns(env, runs, [&] {
+            table.clear();
+            table.insertHost(keys.data(), values.data(), entries);
+        });
+        bool sizeOk = table.size() == entries && table.failedInserts() == 0;
+        table.lookupDevice(dProbe.as<uint32_t>(), dOut.as<uint32_t>(), lookups, MISSING);
+        double tDeviceProbe = timeRuns(env, runs, [&] {
+            table.lookupDevice(dProbe.as<uint32_t>(), dOut.as<uint32_t>(), lookups, MISSING);
+        });
+        svmMemcpy(env, out.data(), dOut.get(), lookups * sizeof(uint32_t));
+        int errors = verify(out, expected) + (sizeOk ? 0 : 1);
+        failures += errors;
+        printf("host-built / device-probed:  build %8.2f Minserts/s   probe %8.2f Mlookups/s   %s\n",
+               entries / tHostBuild / 1e6, lookups / tDeviceProbe / 1e6, errors == 0 ? "ok" : "MISMATCH");
+
+        // device-built / host-probed
+        double tDeviceBuild = timeRuns(env, runs, [&] {
+            table.clear();
+            table.insertDevice(dKeys.as<uint32_t>(), dValues.as<uint32_t>(), entries);
+        });
+        sizeOk = table.size() == entries && table.failedInserts() == 0;
+        double tHostProbe = timeRuns(env, runs, [&] { table.lookupHost(probe.data(), out.data(), lookups, MISSING); });
+        errors = verify(out, expected) + (sizeOk ? 0 : 1);
+        failures += errors;
+        printf("device-built / host-probed:  build %8.2f Minserts/s   probe %8.2f Mlookups/s   %s\n",
+               entries / tDeviceBuild / 1e6, lookups / tHostProbe / 1e6, errors == 0 ? "ok" : "MISMATCH");
+
+        // host update of a device-built table, seen by the next device probe
+        std::vector<uint32_t> updated(values.size());
+        for (uint32_t i = 0; i < entries; ++i)
+            updated[i] = values[i] + 1;
+        table.insertHost(keys.data(), updated.data(), entries);
+        table.lookupDevice(dProbe.as<uint32_t>(), dOut.as<uint32_t>(), lookups, MISSING);
+        svmMemcpy(env, out.data(), dOut.get(), lookups * sizeof(uint32_t));
+        for (auto& e : expected)
+            if (e != MISSING) e++;
+        errors = verify(out, expected) + (table.size() == entries ? 0 : 1);
+        failures += errors;
+        printf("host update, device probe:  %s\n", errors == 0 ? "ok" : "MISMATCH");
+
+        // the reserved key is rejected on both paths, nothing is stored
+        uint32_t reserved = SvmHashTable::EMPTY_KEY, value = 7;
+        uint32_t failedBefore = table.failedInserts();
+        bool rejected = table.insertHost(&reserved, &value, 1) == 1;
+        SvmAlloc dReserved(env, sizeof(uint32_t)), dValue(env, sizeof(uint32_t));
+        svmMemcpy(env, dReserved.get(), &reserved, sizeof(uint32_t));
+        svmMemcpy(env, dValue.get(), &value, sizeof(uint32_t));
+        table.insertDevice(dReserved.as<uint32_t>(), dValue.as<uint32_t>(), 1);
+        rejected = rejected && table.failedInserts() == failedBefore + 2 && table.size() == entries;
+        failures += rejected ? 0 : 1;
+        printf("reserved key rejected:      %s\n", rejected ? "ok" : "MISMATCH");
+        return failures == 0 ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
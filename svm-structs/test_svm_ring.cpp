@@ -0,0 +1,158 @@
+// Host <-> device messaging through fine-grain SVM rings while one kernel
+// keeps running, against one enqueueNDRangeKernel round trip per message.
+//
+// A worker kernel pops requests from the `in` ring, computes v * 3 + 1 and
+// pushes the answer to the `out` ring until it sees STOP. spsc runs one
+// worker work-item; mpmc runs `workers` of them (one per work-group, so no
+// two spinning lanes share a SIMD thread) fed by two host producer threads.
+//
+//   ping-pong   push one, wait for its answer: round-trip latency
+//   stream      producers keep the ring full: messages per second
+//   launch      write, launch, read back one value per message
+//
+// usage: ./app [messages] [workers]
+
+#include "svm_common.h"
+#include "svm_ring.h"
+
+#include <cstdlib>
+
+static const char* workerSource = R"(
+#define STOP ((ulong)-1)
+
+__kernel void ringWorker(__global RingHeader* inH, __global RingSlot* inSlots,
+                         __global RingHeader* outH, __global RingSlot* outSlots)
+{
+    for (;;) {
+        ulong v;
+        if (!ringPop(inH, inSlots, &v))
+            continue;
+        if (v == STOP)
+            break;
+        ulong r = v * 3 + 1;
+        while (!ringPush(outH, outSlots, r))
+            ;
+    }
+}
+
+__kernel void launchEcho(__global const ulong* in, __global ulong* out)
+{
+    out[0] = in[0] * 3 + 1;
+}
+)";
+
+static const uint64_t STOP = ~(uint64_t)0;
+
+// returns false if the device stopped answering
+static bool runRing(OclEnv& env, RingKind kind, int messages, int workers) {
+    cl::Program program = buildProgram(env, std::string(svmRingSource) + workerSource, ringOptions(kind));
+    cl::Kernel worker(program, "ringWorker");
+    if (kind == RingKind::Spsc)
+        workers = 1;
+
+    SvmRing in(env, 1024, kind), out(env, 1024, kind);
+    in.setArgs(worker, 0);
+    out.setArgs(worker, 2);
+    env.queue.enqueueNDRangeKernel(worker, cl::NullRange, cl::NDRange(workers), cl::NDRange(1));
+    env.queue.flush();
+
+    bool ok = true;
+    auto stopWorkers = [&] {
+        for (int w = 0; w < workers; ++w)
+            in.push(STOP);
+        env.queue.finish();
+    };
+
+    // ping-pong, first answers include the kernel start
+    std::vector<double> rtt;
+    for (int i = 0; i < std::min(messages, 100000) && ok; ++i) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        uint64_t r = 0;
+        ok = in.push((uint64_t)i) && out.pop(r);
+        rtt.push_back(secondsSince(t0));
+        ok = ok && r == (uint64_t)i * 3 + 1;
+    }
+    if (!ok) {
+        std::cerr << ringKindName(kind) << ": no answer from the device worker (does it run concurrently with the host?)" << std::endl;
+        stopWorkers();
+        return false;
+    }
+    rtt.erase(rtt.begin(), rtt.begin() + std::min<size_t>(rtt.size(), 16));
+
+    // stream: spsc has one host producer, mpmc two
+    int producers = kind == RingKind::Spsc ? 1 : 2;
+    std::atomic<bool> producerFailed(false);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&, p] {
+            for (int i = p; i < messages; i += producers)
+                if (!in.push((uint64_t)i)) {
+                    producerFailed = true;
+                    return;
+                }
+        });
+    uint64_t sum = 0, expected = 0;
+    for (int i = 0; i < messages && ok; ++i) {
+        uint64_t r = 0;
+        ok = out.pop(r);
+        sum += r;
+        expected += (uint64_t)i * 3 + 1;
+    }
+    for (auto& t : threads)
+        t.join();
+    double tStream = secondsSince(t0);
+    ok = ok && !producerFailed && sum == expected;
+    stopWorkers();
+
+    printf("%-6s workers %-3d ping-pong median %7.2f us  p99 %7.2f us   stream %7.2f Mmsg/s  %s\n", ringKindName(kind),
+           workers, percentile(rtt, 0.5) * 1e6, percentile(rtt, 0.99) * 1e6, messages / tStream / 1e6,
+           ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+static void runLaunches(OclEnv& env, int messages) {
+    cl::Program program = buildProgram(env, std::string(svmRingSource) + workerSource, ringOptions(RingKind::Spsc));
+    cl::Kernel echo(program, "launchEcho");
+    cl::Buffer in(env.context, CL_MEM_READ_ONLY, sizeof(cl_ulong));
+    cl::Buffer out(env.context, CL_MEM_WRITE_ONLY, sizeof(cl_ulong));
+    echo.setArg(0, in);
+    echo.setArg(1, out);
+
+    int n = std::min(messages, 10000);
+    std::vector<double> rtt;
+    for (int i = 0; i < n; ++i) {
+        auto t0 = std::chrono::high_resolution_clock::now();
+        cl_ulong v = i, r = 0;
+        env.queue.enqueueWriteBuffer(in, CL_FALSE, 0, sizeof(v), &v);
+        env.queue.enqueueNDRangeKernel(echo, cl::NullRange, cl::NDRange(1), cl::NullRange);
+        env.queue.enqueueReadBuffer(out, CL_TRUE, 0, sizeof(r), &r);
+        rtt.push_back(secondsSince(t0));
+    }
+    rtt.erase(rtt.begin(), rtt.begin() + std::min<size_t>(rtt.size(), 16));
+    printf("%-6s             round trip median %7.2f us  p99 %7.2f us\n", "launch", percentile(rtt, 0.5) * 1e6,
+           percentile(rtt, 0.99) * 1e6);
+}
+
+int main(int argc, char** argv) {
+    int messages = argc > 1 ? atoi(argv[1]) : 1000000;
+    int workers = argc > 2 ? atoi(argv[2]) : 8;
+
+    try {
+        OclEnv env = OclEnv::create();
+        printSvmCaps(env);
+
+        runLaunches(env, messages);
+        if (!svmFineGrainBuffer(env) || !svmAtomics(env)) {
+            std::cout << "Device does not support fine-grain buffer SVM with atomics, ring tests skipped." << std::endl;
+            return 0;
+        }
+        bool ok = runRing(env, RingKind::Spsc, messages, workers);
+        ok = runRing(env, RingKind::Mpmc, messages, workers) && ok;
+        return ok ? 0 : 1;
+
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << std::endl;
+        return 1;
+    }
+}
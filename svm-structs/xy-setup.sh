@@ -0,0 +1,23 @@
+sudo apt install opencl-header ocl-icd-opencl-dev
+
+# spsc / mpmc ring buffers in fine-grain SVM with atomics: host <-> running kernel
+# messaging vs one launch per message (needs CL_DEVICE_SVM_ATOMICS)
+source build.sh test_svm_ring.cpp
+./app 1000000 8 2>&1 | tee mylog
+
+# persistent kernel fed by an SVM task queue vs one launch per task
+# (falls back to launches without SVM atomics)
+source build.sh test_persistent.cpp
+./app 4096 10000 256 2>&1 | tee mylog
+
+# open-addressing hash table in SVM: host-built / device-probed and device-built / host-probed
+source build.sh test_svm_hash.cpp
+./app 4194304 16777216 5 2>&1 | tee mylog
+
+# CSR / ELL sparse matrices in SVM: scalar / vector / ELL SpMV and SpMM on power-law matrices
+source build.sh test_svm_sparse.cpp
+./app 1048576 16 16 10 2>&1 | tee mylog
+
+# BFS over a malloc-built pointer graph through fine-grain system SVM vs flatten-to-CSR + upload
+source build.sh test_graph_bfs.cpp
+./app 1048576 8 5 2>&1 | tee mylog